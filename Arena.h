@@ -0,0 +1,261 @@
+/*
+ * Arena.h
+ * A monotonic (bump pointer) arena, and an allocator to use it with the standard containers.
+ *
+ * Objects are never freed one by one: the whole arena is either reset, to be reused, or destroyed.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * @brief A memory arena that hands out memory from big blocks, by just moving a pointer
+ *
+ * Objects created with create() have their destructors called when the arena is reset or destroyed.
+ * Raw memory from allocate() is simply forgotten.
+ */
+class MonotonicArena {
+private:
+	struct Block {
+		Block * next;
+		size_t size;	// usable bytes after the header
+		size_t used;
+	};
+
+	struct Finalizer {
+		void (*destroy)(void *);
+		void * object;
+		Finalizer * next;
+	};
+
+	Block * first;
+	Block * current;
+	Finalizer * finalizers;
+	size_t blockSize;
+	size_t bytesUsed;
+
+	static char * blockData(Block * block);
+	Block * newBlock(size_t size);
+	void runFinalizers();
+
+	template<typename T>
+	static void destroyObject(void * object);
+
+public:
+	explicit MonotonicArena(size_t blockSize = 64 * 1024);
+	~MonotonicArena();
+
+	MonotonicArena(const MonotonicArena &) = delete;
+	MonotonicArena & operator=(const MonotonicArena &) = delete;
+
+	void * allocate(size_t size, size_t alignment);
+
+	template<typename T, typename ... Args>
+	T * create(Args && ... args);
+
+	void reset();
+	void swap(MonotonicArena & other);
+	size_t getBytesUsed() const;
+};
+
+/**
+ * @brief Creates an empty arena, the first block is only allocated when needed
+ *
+ * @param blockSize - the size of each block of memory requested to the system
+ */
+inline MonotonicArena::MonotonicArena(size_t blockSize) {
+	this->first = NULL;
+	this->current = NULL;
+	this->finalizers = NULL;
+	this->blockSize = blockSize;
+	this->bytesUsed = 0;
+}
+
+/**
+ * @brief Destroys every object created in the arena and frees all its blocks
+ */
+inline MonotonicArena::~MonotonicArena() {
+	runFinalizers();
+
+	while (first != NULL) {
+		Block * next = first->next;
+		free(first);
+		first = next;
+	}
+}
+
+inline char * MonotonicArena::blockData(Block * block) {
+	return reinterpret_cast<char *>(block) + sizeof(Block);
+}
+
+inline MonotonicArena::Block * MonotonicArena::newBlock(size_t size) {
+	Block * block = static_cast<Block *>(malloc(sizeof(Block) + size));
+	if (block == NULL)
+		throw bad_alloc();
+
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+/**
+ * @brief Calls the destructors of the objects created in the arena, newest first
+ */
+inline void MonotonicArena::runFinalizers() {
+	while (finalizers != NULL) {
+		finalizers->destroy(finalizers->object);
+		finalizers = finalizers->next;
+	}
+}
+
+template<typename T>
+void MonotonicArena::destroyObject(void * object) {
+	static_cast<T *>(object)->~T();
+}
+
+/**
+ * @brief Gets raw memory from the arena
+ * If the current block is full, the next (already allocated) block is reused, or a new one is requested
+ *
+ * @param size - the number of bytes
+ * @param alignment - the alignment of the memory, must be a power of 2
+ * @return pointer to the memory, valid until the arena is reset or destroyed
+ */
+inline void * MonotonicArena::allocate(size_t size, size_t alignment) {
+
+	while (current != NULL) {
+		size_t start = (reinterpret_cast<size_t>(blockData(current)) + current->used + alignment - 1)
+				& ~(alignment - 1);
+		size_t end = start + size - reinterpret_cast<size_t>(blockData(current));
+
+		if (end <= current->size) {
+			current->used = end;
+			bytesUsed += size;
+			return reinterpret_cast<void *>(start);
+		}
+
+		if (current->next == NULL)
+			break;
+
+		// blocks kept by reset() are reused in order
+		current = current->next;
+		current->used = 0;
+	}
+
+	Block * block = newBlock(max(blockSize, size + alignment));
+
+	if (current == NULL) {
+		block->next = first;
+		first = block;
+	} else {
+		block->next = current->next;
+		current->next = block;
+	}
+	current = block;
+
+	return allocate(size, alignment);
+}
+
+/**
+ * @brief Creates an object in the arena
+ * Its destructor will be called when the arena is reset or destroyed
+ *
+ * @param args - the arguments for the object's constructor
+ * @return pointer to the new object
+ */
+template<typename T, typename ... Args>
+T * MonotonicArena::create(Args && ... args) {
+	T * object = new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+
+	if (!is_trivially_destructible<T>::value) {
+		Finalizer * finalizer = static_cast<Finalizer *>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+		finalizer->destroy = &MonotonicArena::destroyObject<T>;
+		finalizer->object = object;
+		finalizer->next = finalizers;
+		finalizers = finalizer;
+	}
+
+	return object;
+}
+
+/**
+ * @brief Releases everything in the arena at once
+ * The blocks are kept, so the next uses of the arena don't need to request memory to the system
+ */
+inline void MonotonicArena::reset() {
+	runFinalizers();
+
+	current = first;
+	if (current != NULL)
+		current->used = 0;
+	bytesUsed = 0;
+}
+
+/**
+ * @brief Exchanges the contents of two arenas
+ *
+ * @param other - the other arena
+ */
+inline void MonotonicArena::swap(MonotonicArena & other) {
+	std::swap(first, other.first);
+	std::swap(current, other.current);
+	std::swap(finalizers, other.finalizers);
+	std::swap(blockSize, other.blockSize);
+	std::swap(bytesUsed, other.bytesUsed);
+}
+
+/**
+ * @brief Returns the number of bytes handed out since the arena was created or reset
+ */
+inline size_t MonotonicArena::getBytesUsed() const {
+	return bytesUsed;
+}
+
+/**
+ * @brief Allocator that takes the memory of a standard container from a MonotonicArena
+ * Deallocation does nothing, the memory is released with the arena
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	MonotonicArena * arena;
+
+	ArenaAllocator(MonotonicArena & arena) :
+			arena(&arena) {
+	}
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U> & other) :
+			arena(other.arena) {
+	}
+
+	T * allocate(size_t n) {
+		return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *, size_t) {
+	}
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b) {
+	return a.arena == b.arena;
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b) {
+	return a.arena != b.arena;
+}
+
+#endif /* ARENA_H_ */
@@ -0,0 +1,223 @@
+/**
+ * @brief Autocompletion of station names, as they are typed
+ *
+ * @file Autocomplete.cpp
+ */
+#include "Autocomplete.h"
+#include "stringSearch.h"
+#include <algorithm>
+
+Autocomplete::Autocomplete() {
+}
+
+/**
+ * @brief Finds the child of a node with a certain label
+ *
+ * @return The child, or NO_NODE if there is none
+ */
+unsigned int Autocomplete::getChild(unsigned int node, char label) const {
+
+	for (unsigned int child = nodes[node].firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+		if (nodes[child].label == label)
+			return child;
+
+	return NO_NODE;
+}
+
+/**
+ * @brief Finds the child of a node with a certain label, creating it if needed
+ */
+unsigned int Autocomplete::addChild(unsigned int node, char label) {
+
+	unsigned int child = getChild(node, label);
+	if (child != NO_NODE)
+		return child;
+
+	TrieNode created;
+	created.label = label;
+	created.firstChild = NO_NODE;
+	created.nextSibling = nodes[node].firstChild;
+	created.completionsStart = 0;
+	created.numCompletions = 0;
+
+	nodes.push_back(created);
+	nodes[node].firstChild = nodes.size() - 1;
+
+	return nodes.size() - 1;
+}
+
+/**
+ * @brief Builds the trie over the names of all the stations of a graph, replacing the one it had
+ *
+ * @param g The graph
+ */
+void Autocomplete::build(const Graph<string> & g) {
+
+	nodes.clear();
+	completions.clear();
+	nodes.push_back(TrieNode());
+	nodes[0].firstChild = NO_NODE;
+	nodes[0].nextSibling = NO_NODE;
+	nodes[0].numCompletions = 0;
+
+	vector<unsigned int> popularity(g.getNumNodes(), 0);
+	const map<string, set<unsigned int>> & stationsByLine = g.getStationsByLine();
+	for (auto it = stationsByLine.begin(); it != stationsByLine.end(); it++)
+		for (unsigned int id : it->second)
+			popularity.at(id)++;
+
+	vector<string> names(g.getNumNodes());
+
+	// the stations whose name (or a part of it) ends at each node
+	vector<vector<unsigned int> > ending(1);
+
+	for (Node<string> * station : g.getNodes()) {
+		string name = foldText(station->getInfo());
+		names.at(station->getId()) = name;
+
+		size_t start = 0;
+
+		while (start < name.length()) {
+			size_t wordEnd = min(name.find(' ', start), name.length());
+
+			if (start == 0 || !isCommonWord(string_view(name).substr(start, wordEnd - start))) {
+				unsigned int node = 0;
+				for (size_t i = start; i < name.length(); i++)
+					node = addChild(node, name[i]);
+
+				ending.resize(nodes.size());
+				ending[node].push_back(station->getId());
+			}
+
+			start = wordEnd + 1;
+		}
+	}
+
+	ending.resize(nodes.size());
+
+	auto better = [&](unsigned int a, unsigned int b) {
+		if (popularity[a] != popularity[b])
+			return popularity[a] > popularity[b];
+		if (names[a] != names[b])
+			return names[a] < names[b];
+		return a < b;
+	};
+
+	// children come after their parents, so going backwards every node is done before its parent
+	vector<unsigned int> list;
+	completions.reserve(nodes.size());
+
+	for (unsigned int node = nodes.size(); node-- > 0;) {
+		list = ending[node];
+
+		for (unsigned int child = nodes[node].firstChild; child != NO_NODE; child = nodes[child].nextSibling)
+			list.insert(list.end(), completions.begin() + nodes[child].completionsStart,
+					completions.begin() + nodes[child].completionsStart + nodes[child].numCompletions);
+
+		sort(list.begin(), list.end(), better);
+		list.erase(unique(list.begin(), list.end()), list.end());
+		if (list.size() > MAX_COMPLETIONS)
+			list.resize(MAX_COMPLETIONS);
+
+		nodes[node].completionsStart = completions.size();
+		nodes[node].numCompletions = list.size();
+		completions.insert(completions.end(), list.begin(), list.end());
+	}
+}
+
+/**
+ * @brief Returns a cursor at the empty text
+ */
+Autocomplete::Cursor Autocomplete::getCursor() const {
+	return Cursor(*this);
+}
+
+/**
+ * @brief Completes a prefix
+ *
+ * @param prefix The prefix, case and accents are ignored
+ * @return The node IDs of the best stations that have a part of the name starting with the prefix, from the most popular
+ */
+vector<unsigned int> Autocomplete::complete(const string & prefix) const {
+	Cursor cursor = getCursor();
+	cursor.type(prefix);
+	return cursor.getCompletions();
+}
+
+/**
+ * @brief Creates a cursor at the empty text
+ *
+ * @param autocomplete The trie it walks
+ */
+Autocomplete::Cursor::Cursor(const Autocomplete & autocomplete) {
+	this->autocomplete = &autocomplete;
+}
+
+/**
+ * @brief Types a character (a byte of it, for multibyte UTF-8 characters)
+ *
+ * @param c The character
+ */
+void Autocomplete::Cursor::type(char c) {
+
+	pending += c;
+
+	// wait for the rest of an UTF-8 character
+	unsigned char lead = pending[0];
+	size_t length = lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+	if (pending.length() < length)
+		return;
+
+	string folded = foldText(pending);
+	pending.clear();
+
+	unsigned int node = path.empty() ? 0 : path.back();
+	for (size_t i = 0; i < folded.length() && node != NO_NODE; i++)
+		node = autocomplete->getChild(node, folded[i]);
+
+	path.push_back(node);
+}
+
+/**
+ * @brief Types a text, a character at a time
+ *
+ * @param text The text
+ */
+void Autocomplete::Cursor::type(const string & text) {
+	for (char c : text)
+		type(c);
+}
+
+/**
+ * @brief Erases the last character typed
+ */
+void Autocomplete::Cursor::erase() {
+	if (!pending.empty())
+		pending.clear();
+	else if (!path.empty())
+		path.pop_back();
+}
+
+/**
+ * @brief Erases all the text
+ */
+void Autocomplete::Cursor::clear() {
+	pending.clear();
+	path.clear();
+}
+
+/**
+ * @brief Returns the completions of the text typed so far
+ *
+ * @return The node IDs of the stations, from the most popular
+ */
+vector<unsigned int> Autocomplete::Cursor::getCompletions() const {
+
+	unsigned int node = path.empty() ? 0 : path.back();
+	if (node == NO_NODE)
+		return vector<unsigned int>();
+
+	const TrieNode & trieNode = autocomplete->nodes[node];
+	return vector<unsigned int>(autocomplete->completions.begin() + trieNode.completionsStart,
+			autocomplete->completions.begin() + trieNode.completionsStart + trieNode.numCompletions);
+}
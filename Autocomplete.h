@@ -0,0 +1,75 @@
+/**
+ * @brief Autocompletion of station names, as they are typed
+ *
+ * @file Autocomplete.h
+ */
+#ifndef AUTOCOMPLETE_H_
+#define AUTOCOMPLETE_H_
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Number of completions kept for each prefix
+ */
+const unsigned int MAX_COMPLETIONS = 5;
+
+/**
+ * @brief Prefix trie over the folded station names and over every part of a name that starts with a word
+ * (so "mus" completes "Casa da Música"), except the ones starting with a common word
+ *
+ * Each node keeps the best completions of its prefix, by popularity (the number of lines through the station),
+ * so completing a prefix is just finding its node. A Cursor follows the trie as the text is typed, a character at a time.
+ */
+class Autocomplete {
+private:
+	struct TrieNode {
+		char label;
+		unsigned int firstChild;
+		unsigned int nextSibling;
+		unsigned int completionsStart;	// position of the completions in the completions vector
+		unsigned int numCompletions;
+	};
+
+	vector<TrieNode> nodes;	// nodes[0] is the root, children always come after their parent
+	vector<unsigned int> completions;	// node IDs of the stations
+
+	unsigned int getChild(unsigned int node, char label) const;
+	unsigned int addChild(unsigned int node, char label);
+
+public:
+	static const unsigned int NO_NODE = UINT_MAX;
+
+	/**
+	 * @brief The state of a text being typed
+	 * Typing or erasing a character takes constant time (for a fixed alphabet)
+	 */
+	class Cursor {
+	private:
+		const Autocomplete * autocomplete;
+		vector<unsigned int> path;	// the trie node after each typed character, NO_NODE once the text left the trie
+		string pending;				// bytes of an UTF-8 character not fully typed yet
+
+	public:
+		explicit Cursor(const Autocomplete & autocomplete);
+
+		void type(char c);
+		void type(const string & text);
+		void erase();
+		void clear();
+
+		vector<unsigned int> getCompletions() const;
+	};
+
+	Autocomplete();
+
+	void build(const Graph<string> & g);
+
+	Cursor getCursor() const;
+	vector<unsigned int> complete(const string & prefix) const;
+};
+
+#endif /* AUTOCOMPLETE_H_ */
@@ -9,19 +9,29 @@
 #define GRAPH_H_
 
 #include <set>
+#include <bitset>
 #include <map>
 #include <cfloat>
 #include <iostream>
 #include <utility>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <algorithm>
 #include <climits>
 #include <string>
 #include <queue>
+#include <deque>
 #include <cmath>
+#include <thread>
+#include <atomic>
 #include "MutablePriorityQueue.h"
+#include "Arena.h"
+#include "SpatialIndex.h"
+#include "LineIndex.h"
+#include "SearchStats.h"
+#include "Trace.h"
 
 const constexpr double BUS_TIME_MULTIPLIER = 0.025;
 const constexpr double SUBWAY_TIME_MULTIPLIER = 0.02;
@@ -33,6 +43,10 @@ const constexpr double WALK_PRICE = 0.0;
 
 const constexpr double DEFAULT_TRANSBORD_TIME = 5.0;
 
+const constexpr unsigned int MAX_LINES = 256; // lines that can share a single (collapsed) edge
+
+const constexpr unsigned int ACCESS_STATIONS = 3; // stations considered around a location given by coordinates
+
 const string TIME_MODE = "time";
 const string PRICE_MODE = "price";
 
@@ -40,8 +54,24 @@ const string BUS = "bus";
 const string WALK = "walk";
 const string SUBWAY = "subway";
 
+/**
+ * Orders in which the Graph's nodes can be renumbered, so that nodes close to each other
+ * are also close in memory (and in the Dijkstra queue)
+ */
+enum NodeOrder {
+	FILE_ORDER = 0,		///< keep the order in which the nodes were loaded
+	HILBERT_ORDER = 1,	///< order the nodes along a Hilbert curve over their x/y positions
+	BFS_ORDER = 2,		///< order the nodes by a breadth-first traversal of the edges
+	DFS_ORDER = 3		///< order the nodes by a depth-first traversal of the edges
+};
+
 using namespace std;
 
+/**
+ * Set of the lines that run along an edge, by their LineRegistry index
+ */
+typedef bitset<MAX_LINES> LineSet;
+
 template<typename T>
 class Edge;
 
@@ -65,10 +95,13 @@ private:
 	int x;
 	int y;
 	double transbord_time;
+	bool contracted = false;	// inside a chain replaced by a shortcut edge
+	const vector<Node<T> *> * lastVia = NULL;	// stops skipped by the shortcut used to get here
 
 	// ---- Needed for Dijkstra with Transbordos ----
 	int numTransbords;
 	string lastConnection = "";
+	LineSet lastLines;	// the lines the traveller may be on, when he gets to this node
 
 	// ---- Needed for Dijsktra with Price -----
 	double price;
@@ -81,22 +114,32 @@ public:
 	virtual ~Node();
 
 	void addEdge(Edge<T> edge);
+	void reserveEdges(unsigned int numEdges);
 	unsigned int getId() const;
+	void setId(unsigned int ID);
+	void remapEdges(const vector<Node<T> *> & nodeByOldID, MonotonicArena & arena);
+	unsigned int collapseParallelEdges();
+	void addShortcut(unsigned int bypassedEdge, const Edge<T> & shortcut);
+	bool isContracted() const;
+	void setContracted(bool contracted);
 	unsigned int getNumberOfEdges() const;
 	const vector<Edge<T>> & getEdges() const;
-	T getInfo() const;
+	const T & getInfo() const;
 	int getX() const;
 	int getY() const;
 	double euclidianDistance(Node<T> * node);
+	double getWalkTime(double x, double y) const;
 	double getTransbordTime() const;
 	void setTransbordTime(double time);
 
 	// ---- Needed for Dijkstra with Transbordos ----
 	int getNumTransbords() const;
 	void setNumTransbords(int i);
-	string getLastConnection() const;
-	void setLastConnection(string connect);
+	const string & getLastConnection() const;
+	void setLastConnection(const string & connect);
 	string getLastTypeConnection() const;
+	const LineSet & getLastLines() const;
+	void setLastLines(const LineSet & lines);
 
 	// ---- DIJKSTRA INFO ----
 	double getDistance() const;
@@ -104,6 +147,8 @@ public:
 	Node* getLastNode();
 	void setLastNode(Node* lastNode);
 	void clearLastNode();
+	const vector<Node<T> *> * getLastVia() const;
+	void setLastVia(const vector<Node<T> *> * via);
 	void setVisited(bool vis);
 	bool getVisited() const;
 	double getPrice() const;
@@ -149,6 +194,18 @@ void Node<T>::setTransbordTime(double time) {
 	this->transbord_time = time;
 }
 
+/**
+ * @brief Returns the time it takes to walk between the Node and a position
+ *
+ * @param x - the x coordinate of the position
+ * @param y - the y coordinate of the position
+ * @return the walking time, as a walk edge between them would have
+ */
+template<typename T>
+double Node<T>::getWalkTime(double x, double y) const {
+	return WALK_TIME_MULTIPLIER * sqrt((this->x - x) * (this->x - x) + (this->y - y) * (this->y - y));
+}
+
 /**
  * @Brief Returns the euclidian distance between two nodes
  *
@@ -157,10 +214,11 @@ void Node<T>::setTransbordTime(double time) {
 template<typename T>
 double Node<T>::euclidianDistance(Node<T> * node) {
 
-	return SUBWAY_TIME_MULTIPLIER
-			* sqrt(
-					(this->x - node->x) * (this->x - node->x)
-							+ (this->y - node->y) * (this->y - node->y));
+	// in double, the squares of the coordinates of big networks don't fit in an int
+	double dx = this->x - node->x;
+	double dy = this->y - node->y;
+
+	return SUBWAY_TIME_MULTIPLIER * sqrt(dx * dx + dy * dy);
 
 }
 
@@ -209,7 +267,7 @@ string Node<T>::getLastTypeConnection() const {
  * @return string containing the information
  */
 template<typename T>
-string Node<T>::getLastConnection() const {
+const string & Node<T>::getLastConnection() const {
 	return this->lastConnection;
 }
 
@@ -219,10 +277,31 @@ string Node<T>::getLastConnection() const {
  * @param connect - a information
  */
 template<typename T>
-void Node<T>::setLastConnection(string connect) {
+void Node<T>::setLastConnection(const string & connect) {
 	this->lastConnection = connect;
 }
 
+/**
+ * @brief Gives the lines the traveller may be on when he reaches this node
+ * There may be more than one when he travels along edges shared by several lines
+ *
+ * @return the set of lines, empty if he got here walking
+ */
+template<typename T>
+const LineSet & Node<T>::getLastLines() const {
+	return this->lastLines;
+}
+
+/**
+ * @brief Sets the lastLines attribute with the lines passed by parameter
+ *
+ * @param lines - the set of lines
+ */
+template<typename T>
+void Node<T>::setLastLines(const LineSet & lines) {
+	this->lastLines = lines;
+}
+
 /**
  * @brief Gives the number of times a person has to change transports when it reaches this node
  *
@@ -305,6 +384,16 @@ void Node<T>::addEdge(Edge<T> edge) {
 	edges.push_back(edge);
 }
 
+/**
+ * @brief Makes room for a number of edges, before adding many at once
+ *
+ * @param numEdges - the total number of edges the node will have
+ */
+template<typename T>
+void Node<T>::reserveEdges(unsigned int numEdges) {
+	edges.reserve(numEdges);
+}
+
 /**
  * @brief Returns the node's ID
  *
@@ -315,6 +404,97 @@ unsigned int Node<T>::getId() const {
 	return ID;
 }
 
+/**
+ * @brief Sets the node's ID
+ * Only meant to be used by the Graph when it renumbers its nodes
+ *
+ * @param ID - the new ID
+ */
+template<typename T>
+void Node<T>::setId(unsigned int ID) {
+	this->ID = ID;
+}
+
+/**
+ * @brief Points every edge of the node to the new copy of its destiny
+ *
+ * @param nodeByOldID - the new Node of each (old) node ID
+ * @param arena - where to keep the remapped stops of the shortcut edges
+ */
+template<typename T>
+void Node<T>::remapEdges(const vector<Node<T> *> & nodeByOldID, MonotonicArena & arena) {
+	for (auto it = this->edges.begin(); it != this->edges.end(); it++) {
+		it->setDestiny(nodeByOldID.at(it->getDestiny()->getId()));
+
+		if (it->isShortcut()) {
+			vector<Node<T> *> * via = arena.create<vector<Node<T> *>>(*it->getVia());
+			for (auto stop = via->begin(); stop != via->end(); stop++)
+				*stop = nodeByOldID.at((*stop)->getId());
+			it->setVia(via);
+		}
+	}
+}
+
+/**
+ * @brief Adds a shortcut edge to the node, replacing one of its edges
+ * The replaced edge is kept, for searches that start or end inside the shortcut
+ *
+ * @param bypassedEdge - the index of the edge replaced by the shortcut
+ * @param shortcut - the shortcut edge
+ */
+template<typename T>
+void Node<T>::addShortcut(unsigned int bypassedEdge, const Edge<T> & shortcut) {
+	this->edges.at(bypassedEdge).setBypassed(true);
+	this->edges.push_back(shortcut);
+}
+
+/**
+ * @brief Tells if the node is inside a chain of stops replaced by a shortcut edge
+ *
+ * @see Graph<T>::contractChains()
+ */
+template<typename T>
+bool Node<T>::isContracted() const {
+	return this->contracted;
+}
+
+/**
+ * @brief Sets the contracted attribute on the Node
+ *
+ * @param contracted - what to set
+ */
+template<typename T>
+void Node<T>::setContracted(bool contracted) {
+	this->contracted = contracted;
+}
+
+/**
+ * @brief Merges the parallel edges of the node, i.e. edges of the same type and weight to the same destiny,
+ * in a single edge that carries all their lines
+ *
+ * @return the number of edges removed
+ */
+template<typename T>
+unsigned int Node<T>::collapseParallelEdges() {
+	vector<Edge<T>> collapsed;
+
+	for (auto it = this->edges.begin(); it != this->edges.end(); it++) {
+
+		bool merged = false;
+
+		for (auto kept = collapsed.begin(); kept != collapsed.end() && !merged; kept++)
+			merged = kept->mergeLines(*it);
+
+		if (!merged)
+			collapsed.push_back(*it);
+	}
+
+	unsigned int removed = this->edges.size() - collapsed.size();
+	this->edges = collapsed;
+
+	return removed;
+}
+
 /**
  * @brief Returns the number of edges the node has
  *
@@ -341,6 +521,27 @@ const vector<Edge<T>> & Node<T>::getEdges() const {
 template<typename T>
 void Node<T>::clearLastNode() {
 	this->lastNode = NULL;
+	this->lastVia = NULL;
+}
+
+/**
+ * @brief Returns the stops skipped by the shortcut edge used to get to this Node
+ *
+ * @return the stops, in travel order, or NULL if it was reached by a normal edge
+ */
+template<typename T>
+const vector<Node<T> *> * Node<T>::getLastVia() const {
+	return this->lastVia;
+}
+
+/**
+ * @brief Sets the lastVia attribute with the stops passed by parameter
+ *
+ * @param via - the stops skipped by the edge used to get to this Node, NULL for a normal edge
+ */
+template<typename T>
+void Node<T>::setLastVia(const vector<Node<T> *> * via) {
+	this->lastVia = via;
 }
 
 /**
@@ -389,7 +590,7 @@ void Node<T>::setDistance(double distance) {
  * @return info
  */
 template<typename T>
-T Node<T>::getInfo() const {
+const T & Node<T>::getInfo() const {
 	return this->info;
 }
 
@@ -448,23 +649,137 @@ bool Node<T>::operator<(Node<T> & node) const {
 //////////////////////////////////////////////////////////////////////////////////
 /////								EDGE									 /////
 //////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Returns the shared copy of a string
+ *
+ * There are only a few different edge types and lines, so each one is stored once
+ * and the edges only keep a pointer to it, instead of their own strings.
+ *
+ * @param s - the string
+ * @return a pointer to the shared copy, valid until the end of the program
+ */
+inline const string * internString(const string & s) {
+	static unordered_set<string> pool;
+	return &*pool.insert(s).first;
+}
+
+/**
+ * @brief Gives every line (by its connection, e.g. "bus 204") a small index, so sets of lines can be kept as bitsets
+ */
+class LineRegistry {
+private:
+	unordered_map<string, unsigned int> indexes;
+	vector<const string *> connections;
+
+public:
+	static LineRegistry & instance();
+
+	unsigned int getIndex(const string & connection);
+	unsigned int findIndex(const string & connection) const;
+	const string & getConnection(unsigned int index) const;
+};
+
+/**
+ * @brief Returns the registry shared by all the edges
+ */
+inline LineRegistry & LineRegistry::instance() {
+	static LineRegistry registry;
+	return registry;
+}
+
+/**
+ * @brief Returns the index of a line, registering it the first time it is seen
+ *
+ * @param connection - the line's connection, e.g. "bus 204"
+ * @return the line's index, or MAX_LINES if there are already too many lines
+ */
+inline unsigned int LineRegistry::getIndex(const string & connection) {
+	auto it = indexes.find(connection);
+	if (it != indexes.end())
+		return it->second;
+
+	if (connections.size() >= MAX_LINES)
+		return MAX_LINES;
+
+	unsigned int index = connections.size();
+	indexes.insert(pair<string, unsigned int>(connection, index));
+	connections.push_back(internString(connection));
+	return index;
+}
+
+/**
+ * @brief Returns the index of an already registered line
+ *
+ * @param connection - the line's connection, e.g. "bus 204"
+ * @return the line's index, or MAX_LINES if it is not registered
+ */
+inline unsigned int LineRegistry::findIndex(const string & connection) const {
+	auto it = indexes.find(connection);
+	return (it == indexes.end()) ? MAX_LINES : it->second;
+}
+
+/**
+ * @brief Returns the connection of a registered line
+ *
+ * @param index - the line's index
+ * @return the line's connection, e.g. "bus 204"
+ */
+inline const string & LineRegistry::getConnection(unsigned int index) const {
+	return *connections.at(index);
+}
+
+/**
+ * @brief Returns the lowest line of a set
+ *
+ * @param lines - the set of lines
+ * @return the line's index, MAX_LINES if the set is empty
+ */
+inline unsigned int getFirstLine(const LineSet & lines) {
+	unsigned int line = 0;
+	while (line < MAX_LINES && !lines.test(line))
+		line++;
+	return line;
+}
+
 template<typename T>
 class Edge {
 protected:
 	Node<T>* destiny;
 	double weight;
-	string type;
-	string lineID;
+	const string * type;
+	const string * lineID;
+	const string * connection;
+	LineSet lines;
+	const vector<Node<T> *> * via;	// stops skipped by a shortcut edge, NULL for normal edges
+	bool bypassed;	// replaced by a shortcut edge
 
 public:
 
 	Edge(Node<T> * destiny, double weight, string type, string lineID);
 	virtual ~Edge();
 	Node<T>* getDestiny() const;
+	void setDestiny(Node<T> * destiny);
 	double getWeight() const;
-	string getType() const;
-	string getLineID() const;
-	string getEdgeConnection() const;
+	double getLength() const;
+	const string & getType() const;
+	[[deprecated("only the first line of a merged edge, use getLines()")]] const string & getLineID() const;
+	const string & getEdgeConnection() const;
+	const string & getEdgeConnection(Node<T> * origin) const;
+	bool continuesRide(Node<T> * origin) const;
+	LineSet getRideLines(Node<T> * origin) const;
+	const LineSet & getLines() const;
+	bool mergeLines(const Edge<T> & edge);
+	bool hasSameService(const Edge<T> & edge) const;
+
+	// ---- Chain contraction ----
+	bool isShortcut() const;
+	const vector<Node<T> *> * getVia() const;
+	void setVia(const vector<Node<T> *> * via);
+	void setShortcut(double weight, const vector<Node<T> *> * via);
+	bool isBypassed() const;
+	void setBypassed(bool bypassed);
+	bool isSkipped(bool useShortcuts) const;
 	double getPriceWeight() const;
 
 };
@@ -476,9 +791,9 @@ public:
  */
 template<typename T>
 double Edge<T>::getPriceWeight() const {
-	if (this->type == BUS)
+	if (*this->type == BUS)
 		return BUS_PRICE;
-	else if (this->type == SUBWAY)
+	else if (*this->type == SUBWAY)
 		return SUBWAY_PRICE;
 	else
 		return WALK_PRICE;
@@ -494,10 +809,183 @@ double Edge<T>::getPriceWeight() const {
  *
  */
 template<typename T>
-string Edge<T>::getEdgeConnection() const {
-	string result = this->type + " " + this->lineID;
+const string & Edge<T>::getEdgeConnection() const {
+	return *this->connection;
+}
+
+/**
+ * @brief Tells if a traveller can go along the edge without changing vehicle,
+ * i.e. if one of the lines he may be on, when he is at the origin of the edge, runs along it
+ *
+ * @param origin - the node at the origin of the edge, as reached by the search
+ * @return true if he stays on the same line, false otherwise
+ */
+template<typename T>
+bool Edge<T>::continuesRide(Node<T> * origin) const {
+
+	// walk edges (and lines the registry couldn't take) are compared by their connection
+	if (this->lines.none())
+		return origin->getLastConnection() == *this->connection;
+
+	return (this->lines & origin->getLastLines()).any();
+}
+
+/**
+ * @brief Returns the lines the traveller may be on after going along the edge
+ *
+ * @param origin - the node at the origin of the edge, as reached by the search
+ * @return the lines he was on that run along the edge, or all the lines of the edge if he has to change
+ */
+template<typename T>
+LineSet Edge<T>::getRideLines(Node<T> * origin) const {
+	LineSet common = this->lines & origin->getLastLines();
+	return common.any() ? common : this->lines;
+}
+
+/**
+ * @brief Returns the connection used to travel along the edge, coming from origin
+ *
+ * If the edge carries several lines (see Graph<T>::collapseParallelEdges()) and the traveller is already on
+ * one of them, he stays on it; otherwise he catches the edge's first line.
+ *
+ * @param origin - the node at the origin of the edge, as reached by the search
+ * @return string containing the information, e.g. "bus 204"
+ */
+template<typename T>
+const string & Edge<T>::getEdgeConnection(Node<T> * origin) const {
+
+	const string & lastConnection = origin->getLastConnection();
+	if (lastConnection == *this->connection)
+		return *this->connection;
+
+	LineSet common = this->lines & origin->getLastLines();
+	if (common.none())
+		return *this->connection;
+
+	const LineRegistry & registry = LineRegistry::instance();
+	unsigned int line = registry.findIndex(lastConnection);
+
+	if (line >= MAX_LINES || !common.test(line))
+		line = getFirstLine(common);
+
+	return registry.getConnection(line);
+}
+
+/**
+ * @brief Returns the lines that run along the edge
+ *
+ * @return the set of lines, by their LineRegistry index
+ */
+template<typename T>
+const LineSet & Edge<T>::getLines() const {
+	return this->lines;
+}
+
+/**
+ * @brief Adds the lines of a parallel edge to this one
+ * Only edges to the same destiny, of the same type and with the same weight can be merged
+ *
+ * @param edge - the parallel edge
+ * @return true if the lines were merged, false if the edges can't be merged
+ */
+template<typename T>
+bool Edge<T>::mergeLines(const Edge<T> & edge) {
+
+	if (this->destiny != edge.destiny || this->type != edge.type || this->weight != edge.weight
+			|| this->lines.none() || edge.lines.none()
+			|| this->via != NULL || edge.via != NULL || this->bypassed || edge.bypassed)
+		return false;
+
+	this->lines |= edge.lines;
+	return true;
+}
+
+/**
+ * @brief Tells if two edges are served by the same vehicles, i.e. have the same type and lines
+ *
+ * @param edge - the other edge
+ * @return true or false
+ */
+template<typename T>
+bool Edge<T>::hasSameService(const Edge<T> & edge) const {
+
+	if (this->type != edge.type || this->lines != edge.lines)
+		return false;
+
+	return this->lines.any() || this->connection == edge.connection;
+}
+
+/**
+ * @brief Tells if the edge is a shortcut over a chain of stops
+ *
+ * @see Graph<T>::contractChains()
+ */
+template<typename T>
+bool Edge<T>::isShortcut() const {
+	return this->via != NULL;
+}
+
+/**
+ * @brief Returns the stops skipped by a shortcut edge
+ *
+ * @return the stops, in travel order, or NULL for a normal edge
+ */
+template<typename T>
+const vector<Node<T> *> * Edge<T>::getVia() const {
+	return this->via;
+}
+
+/**
+ * @brief Sets the stops skipped by a shortcut edge
+ *
+ * @param via - the stops, in travel order
+ */
+template<typename T>
+void Edge<T>::setVia(const vector<Node<T> *> * via) {
+	this->via = via;
+}
+
+/**
+ * @brief Turns the edge into a shortcut over a chain of stops
+ *
+ * @param weight - the sum of the weights of the edges along the chain
+ * @param via - the stops skipped, in travel order
+ */
+template<typename T>
+void Edge<T>::setShortcut(double weight, const vector<Node<T> *> * via) {
+	this->weight = weight;
+	this->via = via;
+	this->bypassed = false;
+}
+
+/**
+ * @brief Tells if the edge was replaced by a shortcut edge
+ */
+template<typename T>
+bool Edge<T>::isBypassed() const {
+	return this->bypassed;
+}
+
+/**
+ * @brief Sets the bypassed attribute on the Edge
+ *
+ * @param bypassed - what to set
+ */
+template<typename T>
+void Edge<T>::setBypassed(bool bypassed) {
+	this->bypassed = bypassed;
+}
 
-	return result;
+/**
+ * @brief Tells if a search must ignore the edge
+ * Searches starting or ending inside a contracted chain can't use the shortcuts, the others don't need the bypassed edges
+ *
+ * @param useShortcuts - true if the search uses the shortcut edges
+ * @return true if the edge must be ignored
+ */
+template<typename T>
+bool Edge<T>::isSkipped(bool useShortcuts) const {
+	return useShortcuts ? this->bypassed : this->via != NULL;
 }
 
 /**
@@ -512,8 +1000,18 @@ template<typename T>
 Edge<T>::Edge(Node<T> * destiny, double weight, string type, string lineID) {
 	this->destiny = destiny;
 	this->weight = weight;
-	this->type = type;
-	this->lineID = lineID;
+	this->type = internString(type);
+	this->lineID = internString(lineID);
+	this->connection = internString(type + " " + lineID);
+	this->via = NULL;
+	this->bypassed = false;
+
+	// walking is not a line, so walk edges are never merged
+	if (type != WALK) {
+		unsigned int line = LineRegistry::instance().getIndex(*this->connection);
+		if (line < MAX_LINES)
+			this->lines.set(line);
+	}
 }
 
 /**
@@ -533,22 +1031,50 @@ Node<T>* Edge<T>::getDestiny() const {
 	return destiny;
 }
 
+/**
+ * @brief Sets the destiny of an Edge
+ *
+ * @param destiny - the new Node in the end of the Edge
+ */
+template<typename T>
+void Edge<T>::setDestiny(Node<T> * destiny) {
+	this->destiny = destiny;
+}
+
 /**
  * @brief Returns the type of an Edge
  *
  * @return the type of the Edge ("walk", "edge", "bus")
  */
 template<typename T>
-string Edge<T>::getType() const {
-	return this->type;
+const string & Edge<T>::getType() const {
+	return *this->type;
 }
 
+/**
+ * @brief Returns the ID of the line the edge was created with
+ *
+ * After Graph<T>::collapseParallelEdges() an edge can carry several lines, and this is only the first one:
+ * use getLines() and the LineRegistry to get all of them.
+ *
+ * @return the line's ID, e.g. "204"
+ */
 template<typename T>
-string Edge<T>::getLineID() const {
-	return this->lineID;
+const string & Edge<T>::getLineID() const {
+	return *this->lineID;
 }
 
 
+/**
+ * @brief Returns the length of the Edge, i.e. its weight without the multiplier of its type of transportation
+ *
+ * @return the length of the Edge
+ */
+template<typename T>
+double Edge<T>::getLength() const {
+	return this->weight;
+}
+
 /**
  * @brief Returns the weight of the Edge and counts in the multiplier considering which type of transportation is
  *
@@ -556,9 +1082,9 @@ string Edge<T>::getLineID() const {
  */
 template<typename T>
 double Edge<T>::getWeight() const {
-	if (this->type == SUBWAY)
+	if (*this->type == SUBWAY)
 		return this->weight * SUBWAY_TIME_MULTIPLIER;
-	else if (this->type == BUS)
+	else if (*this->type == BUS)
 		return this->weight * BUS_TIME_MULTIPLIER;
 	else
 		return this->weight * WALK_TIME_MULTIPLIER;
@@ -572,6 +1098,25 @@ class Graph {
 private:
 	vector<Node<T> *> nodes;
 	map<string, set<unsigned int>> listStationsByLine;
+	vector<unsigned int> originalIDs;	// current ID -> ID the node was loaded with
+	vector<unsigned int> currentIDs;	// ID the node was loaded with -> current ID
+
+	MonotonicArena nodeArena;	// storage of the nodes, freed all at once with the graph
+	MonotonicArena searchArena;	// scratch memory of a search, released at the start of the next one
+	SpatialIndex spatialIndex;	// the nodes by their position, empty until buildSpatialIndex()
+	LineIndex lineIndex;		// the stations of each line and the lines of each station, empty until buildLineIndex()
+
+	typedef MutablePriorityQueue<Node<T>, ArenaAllocator<Node<T> *> > SearchQueue;
+
+	vector<unsigned int> getHilbertOrder() const;
+	vector<unsigned int> getTraversalOrder(bool breadthFirst) const;
+	bool isChainStop(Node<T> * node, const vector<vector<pair<Node<T> *, const Edge<T> *> > > & incoming) const;
+	void unpackShortcuts(Node<T> * dest);
+	vector<pair<unsigned int, double> > getWalkClosure(unsigned int source,
+			const vector<vector<pair<unsigned int, double> > > & walkGraph) const;
+
+	template<typename Task>
+	static void parallelFor(unsigned int size, unsigned int numThreads, Task task);
 public:
 	Graph();
 
@@ -580,87 +1125,766 @@ public:
 	void addNode(T nodeData, int x, int y);
 	unsigned int getNumNodes() const;	//Get the number of nodes in the graph
 	Node<T> * getNodeByID(unsigned int ID) const;//Get one node of the graph by its ID
+	Node<T> * getNodeByOriginalID(unsigned int originalID) const;
+	unsigned int getOriginalID(unsigned int ID) const;
+	void reorderNodes(NodeOrder order);
 	unsigned int getNumEdges() const; 	// Get the number of edges in the graph
 	vector<Node<T> *> getNodes() const;
-	map<string, set<unsigned int>> getStationsByLine() const;
+	const map<string, set<unsigned int>> & getStationsByLine() const;
 	void findInterfaces();
+	unsigned int collapseParallelEdges();
+	unsigned int contractChains();
+	void buildSpatialIndex();
+	void buildLineIndex();
+	const LineIndex & getLineIndex() const;
+	vector<Node<T> *> getNearestNodes(double x, double y, unsigned int k) const;
+	vector<Node<T> *> getNodesInRadius(double x, double y, double radius) const;
+	vector<Node<T> *> getNodesInRectangle(double minX, double minY, double maxX, double maxY) const;
+	unsigned int generateFootpaths(double radius, bool transitiveClosure = false, unsigned int numThreads = 0);
 	void insertStation(string lineID, unsigned int sourceNodeID, unsigned int destinyNodeID);
 
-// ---- Edges Types ----
-	void addBusEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
-			double weight, string lineID);
-	void addSubwayEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
-			double weight, string lineID);
-	void addWalkEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
-			double weight, string lineID);
+// ---- Edges Types ----
+	void addBusEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
+			double weight, string lineID);
+	void addSubwayEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
+			double weight, string lineID);
+	void addWalkEdge(unsigned int sourceNodeID, unsigned int destinyNodeID,
+			double weight, string lineID);
+
+	vector<T> getPath(Node<T> * dest);
+
+	vector<Node<T>*> getDetailedPath(Node<T> * dest);
+
+// ---- Dijkstra Algorithms ----
+// (each one takes an optional statistics policy, see SearchStats.h)
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_heap(Node<T> * startNode, Node<T> * endNode, Stats && stats = Stats());
+
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_queue(Node<T> * startNode, Node<T> * endNode, Stats && stats = Stats());
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_queue_NO_WALK(Node<T> * startNode, Node<T> * endNode, Stats && stats = Stats());
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_queue_TRANSBORDS(Node<T> * startNode, Node<T> * endNode,
+			int maxNum, Stats && stats = Stats());
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
+			double walk_distance, Stats && stats = Stats());
+	template<typename Stats = NoSearchStats>
+	Node<T> * dijkstra_queue_LOCATIONS(double startX, double startY, double endX, double endY,
+			unsigned int numStations = ACCESS_STATIONS, Stats && stats = Stats());
+
+	// Print in the screen
+	void presentPath(vector<Node<T>*> invertedPath);
+
+// ---- A Star Algorithms ----
+	template<typename Stats = NoSearchStats>
+	Node<T> * A_Star(Node<T> * startNode, Node<T> * endNode, Stats && stats = Stats());
+};
+
+/**
+ * @brief Checks which nodes of the graph are an interface for the different types of transports.
+ *
+ * By interface, we mean a single stop where the user can catch the bus or subway.
+ * There will be a certain time of exchanging between them.
+ *
+ */
+template<typename T>
+void Graph<T>::findInterfaces() {
+	TRACE_SCOPE("findInterfaces", "preprocess");
+
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
+
+		set<string> types;
+
+		for (auto i = (*it)->getEdges().begin(); i != (*it)->getEdges().end();
+				i++) {
+
+			if (i->getType() != WALK) {
+				types.insert(i->getType());
+
+				if (types.size() > 1) {
+					(*it)->setTransbordTime(DEFAULT_TRANSBORD_TIME);
+					types.clear();
+					break;
+				}
+			}
+
+		}
+
+		types.clear();
+
+	}
+
+}
+
+/**
+ * @brief Merges, in every node, the edges of several lines that share the same track segment
+ * in a single edge carrying all those lines, so the searches relax it only once.
+ *
+ * The searches still follow the lines: a traveller stays on his line while it runs along the edge.
+ *
+ * @return the number of edges removed
+ */
+template<typename T>
+unsigned int Graph<T>::collapseParallelEdges() {
+	TRACE_SCOPE("collapseParallelEdges", "preprocess");
+
+	unsigned int removed = 0;
+
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++)
+		removed += (*it)->collapseParallelEdges();
+
+	return removed;
+}
+
+/**
+ * @brief Tells if a node is a stop in the middle of a single line corridor:
+ * it's not an interface, it can't be reached walking, and it has exactly two neighbours,
+ * with every vehicle that arrives from one of them continuing to the other one
+ *
+ * @param node - the node
+ * @param incoming - the edges that arrive at each node, with their origin
+ * @return true or false
+ */
+template<typename T>
+bool Graph<T>::isChainStop(Node<T> * node,
+		const vector<vector<pair<Node<T> *, const Edge<T> *> > > & incoming) const {
+
+	const vector<Edge<T>> & out = node->getEdges();
+	const vector<pair<Node<T> *, const Edge<T> *> > & in = incoming.at(node->getId());
+
+	if (node->getTransbordTime() != 0 || out.empty() || out.size() > 2 || in.size() != out.size())
+		return false;
+
+	set<Node<T> *> neighbours;
+
+	for (auto it = out.begin(); it != out.end(); it++) {
+		if (it->getType() == WALK || it->isShortcut() || it->isBypassed())
+			return false;
+		neighbours.insert(it->getDestiny());
+	}
+
+	for (auto it = in.begin(); it != in.end(); it++) {
+		if (it->second->getType() == WALK)
+			return false;
+		neighbours.insert(it->first);
+	}
+
+	if (neighbours.size() != 2)
+		return false;
+
+	// whoever arrives from one neighbour must be able to continue, on the same vehicle, to the other
+	for (auto it = in.begin(); it != in.end(); it++) {
+		bool continues = false;
+
+		for (auto next = out.begin(); next != out.end() && !continues; next++)
+			continues = next->getDestiny() != it->first && next->hasSameService(*it->second);
+
+		if (!continues)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Replaces every maximal chain of stops in the middle of a single line corridor (see isChainStop())
+ * by a single shortcut edge, from the stop before the chain to the stop after it, that keeps the stops it skips.
+ *
+ * The searches relax the shortcut instead of the first edge of the chain, so they don't settle every stop along it.
+ * getPath() and getDetailedPath() expand the shortcuts back into the full itinerary.
+ * Searches that start or end inside a chain ignore the shortcuts.
+ *
+ * @return the number of shortcut edges added
+ */
+template<typename T>
+unsigned int Graph<T>::contractChains() {
+	TRACE_SCOPE("contractChains", "preprocess");
+
+	vector<vector<pair<Node<T> *, const Edge<T> *> > > incoming(nodes.size());
+
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++)
+		for (auto e = (*it)->getEdges().begin(); e != (*it)->getEdges().end(); e++)
+			incoming.at(e->getDestiny()->getId()).push_back(pair<Node<T> *, const Edge<T> *>(*it, &*e));
+
+	vector<bool> chainStop(nodes.size());
+	for (unsigned int i = 0; i < nodes.size(); i++)
+		chainStop[i] = isChainStop(nodes[i], incoming);
+
+	// the shortcuts are only added in the end, so the edges aren't reallocated while they are followed
+	vector<pair<pair<Node<T> *, unsigned int>, Edge<T> > > shortcuts;
+
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
+
+		if (chainStop[(*it)->getId()])
+			continue;
+
+		const vector<Edge<T>> & edges = (*it)->getEdges();
+
+		for (unsigned int i = 0; i < edges.size(); i++) {
+
+			const Edge<T> & first = edges[i];
+			if (first.isShortcut() || first.isBypassed() || !chainStop[first.getDestiny()->getId()])
+				continue;
+
+			vector<Node<T> *> stops;
+			Node<T> * previous = *it;
+			Node<T> * current = first.getDestiny();
+			double length = first.getLength();
+
+			// follow the vehicle until it leaves the chain
+			while (chainStop[current->getId()] && stops.size() < nodes.size()) {
+				stops.push_back(current);
+
+				const Edge<T> * next = NULL;
+				for (auto e = current->getEdges().begin(); e != current->getEdges().end(); e++)
+					if (e->getDestiny() != previous && e->hasSameService(first))
+						next = &*e;
+
+				length += next->getLength();
+				previous = current;
+				current = next->getDestiny();
+			}
+
+			// a ring with a single stop outside the chain has nowhere to go
+			if (current == *it || chainStop[current->getId()])
+				continue;
+
+			for (auto stop = stops.begin(); stop != stops.end(); stop++)
+				(*stop)->setContracted(true);
+
+			Edge<T> shortcut = first;
+			shortcut.setDestiny(current);
+			shortcut.setShortcut(length, nodeArena.create<vector<Node<T> *>>(stops));
+			shortcuts.push_back(pair<pair<Node<T> *, unsigned int>, Edge<T> >(
+					pair<Node<T> *, unsigned int>(*it, i), shortcut));
+		}
+	}
+
+	for (auto it = shortcuts.begin(); it != shortcuts.end(); it++)
+		it->first.first->addShortcut(it->first.second, it->second);
+
+	return shortcuts.size();
+}
+
+/**
+ * @brief Returns a node by its ID
+ * 
+ * @tparam T 
+ * @param ID Node ID
+ * @return Node<T>* A pointer to the node
+ * @throw out_of_range If the node doesn't exist
+ */
+template<typename T>
+Node<T> * Graph<T>::getNodeByID(unsigned int ID) const {
+	return this->nodes.at(ID);
+}
+
+/**
+ * @brief Returns a node by the ID it had when it was loaded, i.e. before any call to reorderNodes()
+ *
+ * @param originalID - the node's ID in the input files
+ * @return Node<T>* A pointer to the node
+ * @throw out_of_range If the node doesn't exist
+ */
+template<typename T>
+Node<T> * Graph<T>::getNodeByOriginalID(unsigned int originalID) const {
+	return this->nodes.at(currentIDs.at(originalID));
+}
+
+/**
+ * @brief Returns the ID a node had when it was loaded, i.e. before any call to reorderNodes()
+ *
+ * @param ID - the node's current ID
+ * @return the node's ID in the input files
+ * @throw out_of_range If the node doesn't exist
+ */
+template<typename T>
+unsigned int Graph<T>::getOriginalID(unsigned int ID) const {
+	return this->originalIDs.at(ID);
+}
+
+/**
+ * @brief Maps a position to its distance along a Hilbert curve that fills a side x side square
+ *
+ * @param side - the side of the square, must be a power of 2
+ * @param x - the x position, between 0 and side - 1
+ * @param y - the y position, between 0 and side - 1
+ * @return the position's index along the curve
+ */
+inline unsigned long long hilbertIndex(unsigned int side, unsigned int x, unsigned int y) {
+	unsigned long long d = 0;
+
+	for (unsigned int s = side / 2; s > 0; s /= 2) {
+		unsigned int rx = (x & s) > 0;
+		unsigned int ry = (y & s) > 0;
+		d += (unsigned long long) s * s * ((3 * rx) ^ ry);
+
+		// rotate the quadrant, so the curve stays continuous
+		if (ry == 0) {
+			if (rx == 1) {
+				x = side - 1 - x;
+				y = side - 1 - y;
+			}
+			swap(x, y);
+		}
+	}
+
+	return d;
+}
+
+/**
+ * @brief Computes the order of the nodes along a Hilbert curve over their positions
+ *
+ * @return the old IDs of the nodes, in their new order
+ */
+template<typename T>
+vector<unsigned int> Graph<T>::getHilbertOrder() const {
+	const unsigned int side = 1 << 16;
+
+	vector<unsigned int> order(nodes.size());
+	if (nodes.empty())
+		return order;
+
+	int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
+		minX = min(minX, (*it)->getX());
+		minY = min(minY, (*it)->getY());
+		maxX = max(maxX, (*it)->getX());
+		maxY = max(maxY, (*it)->getY());
+	}
+
+	// scale both axes by the same factor, so the curve is not distorted
+	double range = max((double) maxX - minX, (double) maxY - minY);
+	double scale = (range > 0) ? (side - 1) / range : 0;
+
+	vector<unsigned long long> keys(nodes.size());
+	for (unsigned int i = 0; i < nodes.size(); i++) {
+		unsigned int x = (unsigned int) ((nodes[i]->getX() - minX) * scale);
+		unsigned int y = (unsigned int) ((nodes[i]->getY() - minY) * scale);
+		keys[i] = hilbertIndex(side, x, y);
+		order[i] = i;
+	}
+
+	stable_sort(order.begin(), order.end(),
+			[&keys](unsigned int a, unsigned int b) {return keys[a] < keys[b];});
+
+	return order;
+}
+
+/**
+ * @brief Computes the order in which a breadth-first or depth-first traversal reaches the nodes
+ * Every component of the graph is traversed, starting by its lowest ID
+ *
+ * @param breadthFirst - true for a breadth-first traversal, false for a depth-first one
+ * @return the old IDs of the nodes, in their new order
+ */
+template<typename T>
+vector<unsigned int> Graph<T>::getTraversalOrder(bool breadthFirst) const {
+	vector<unsigned int> order;
+	vector<bool> reached(nodes.size(), false);
+	deque<unsigned int> pending;
+
+	order.reserve(nodes.size());
+
+	for (unsigned int root = 0; root < nodes.size(); root++) {
+
+		if (reached[root])
+			continue;
+
+		pending.push_back(root);
+		if (breadthFirst)
+			reached[root] = true;
+
+		while (!pending.empty()) {
+
+			unsigned int id;
+			if (breadthFirst) {
+				id = pending.front();
+				pending.pop_front();
+			} else {
+				id = pending.back();
+				pending.pop_back();
+				if (reached[id])
+					continue;
+				reached[id] = true;
+			}
+
+			order.push_back(id);
+
+			const vector<Edge<T>> & edges = nodes[id]->getEdges();
+
+			if (breadthFirst) {
+				for (auto it = edges.begin(); it != edges.end(); it++) {
+					unsigned int next = it->getDestiny()->getId();
+					if (!reached[next]) {
+						reached[next] = true;
+						pending.push_back(next);
+					}
+				}
+			} else {
+				// pushed in reverse, so the first edge is the first to be followed
+				for (auto it = edges.rbegin(); it != edges.rend(); it++) {
+					unsigned int next = it->getDestiny()->getId();
+					if (!reached[next])
+						pending.push_back(next);
+				}
+			}
+		}
+	}
+
+	return order;
+}
+
+/**
+ * @brief Renumbers the nodes of the graph, so that nodes that are close to each other get close IDs
+ *
+ * The nodes are copied in the new order, so they are also close in memory, and every edge and line is remapped to the new IDs.
+ * The IDs the nodes were loaded with can still be obtained with getOriginalID() and getNodeByOriginalID().
+ * Any Node pointer obtained before the call is invalidated.
+ *
+ * @param order - the new order of the nodes
+ */
+template<typename T>
+void Graph<T>::reorderNodes(NodeOrder order) {
+	TRACE_SCOPE("reorderNodes", "preprocess");
+
+	vector<unsigned int> newOrder;
+
+	switch (order) {
+	case HILBERT_ORDER:
+		newOrder = getHilbertOrder();
+		break;
+	case BFS_ORDER:
+		newOrder = getTraversalOrder(true);
+		break;
+	case DFS_ORDER:
+		newOrder = getTraversalOrder(false);
+		break;
+	default:
+		return;
+	}
+
+	// the copies are made in a new arena, so they end up contiguous in memory
+	MonotonicArena newArena;
+	vector<Node<T> *> newNodes(nodes.size());
+	vector<Node<T> *> nodeByOldID(nodes.size());
+	vector<unsigned int> newIDs(nodes.size());
+	vector<unsigned int> newOriginalIDs(nodes.size());
+
+	for (unsigned int i = 0; i < newOrder.size(); i++) {
+		unsigned int oldID = newOrder[i];
+
+		newNodes[i] = newArena.create<Node<T>>(*nodes[oldID]);
+		newNodes[i]->clearLastNode();
+		nodeByOldID[oldID] = newNodes[i];
+		newIDs[oldID] = i;
+		newOriginalIDs[i] = originalIDs[oldID];
+	}
+
+	// the old nodes still hold the old IDs, needed to remap the edges
+	for (auto it = newNodes.begin(); it != newNodes.end(); it++)
+		(*it)->remapEdges(nodeByOldID, newArena);
+
+	for (unsigned int i = 0; i < newNodes.size(); i++)
+		newNodes[i]->setId(i);
+
+	// the old nodes are destroyed with the swapped arena
+	this->nodeArena.swap(newArena);
+	this->nodes = newNodes;
+	this->originalIDs = newOriginalIDs;
+
+	for (auto it = this->currentIDs.begin(); it != this->currentIDs.end(); it++)
+		*it = newIDs[*it];
+
+	for (auto it = this->listStationsByLine.begin(); it != this->listStationsByLine.end(); it++) {
+		set<unsigned int> stations;
+		for (auto st = it->second.begin(); st != it->second.end(); st++)
+			stations.insert(newIDs[*st]);
+		it->second = stations;
+	}
+
+	if (!this->spatialIndex.empty())
+		buildSpatialIndex();
+
+	if (!this->lineIndex.empty())
+		buildLineIndex();
+}
+
+/**
+ * @brief Builds the index of the nodes by their position, used by getNearestNodes() and getNodesInRadius()
+ * It's rebuilt by reorderNodes(), but must be built again if nodes are added
+ */
+template<typename T>
+void Graph<T>::buildSpatialIndex() {
+	TRACE_SCOPE("buildSpatialIndex", "preprocess");
+
+	vector<SpatialIndex::Point> points(nodes.size());
+
+	for (unsigned int i = 0; i < nodes.size(); i++) {
+		points[i].x = nodes[i]->getX();
+		points[i].y = nodes[i]->getY();
+		points[i].id = nodes[i]->getId();
+	}
+
+	this->spatialIndex.build(points);
+}
+
+/**
+ * @brief Builds the index of the stations of each line and the lines of each station, returned by getLineIndex()
+ * It's rebuilt by reorderNodes(), but must be built again if nodes or lines are added
+ */
+template<typename T>
+void Graph<T>::buildLineIndex() {
+	TRACE_SCOPE("buildLineIndex", "preprocess");
+
+	this->lineIndex.build(this->listStationsByLine, nodes.size());
+}
+
+/**
+ * @brief Returns the index of the stations of each line and the lines of each station, see buildLineIndex()
+ */
+template<typename T>
+const LineIndex & Graph<T>::getLineIndex() const {
+	return this->lineIndex;
+}
+
+/**
+ * @brief Finds the nodes closest to a position, using the spatial index
+ *
+ * @param x - the x coordinate of the position
+ * @param y - the y coordinate of the position
+ * @param k - the number of nodes wanted
+ * @return the nodes, from the closest to the farthest (none if the index wasn't built)
+ */
+template<typename T>
+vector<Node<T> *> Graph<T>::getNearestNodes(double x, double y, unsigned int k) const {
+
+	vector<unsigned int> ids = this->spatialIndex.nearest(x, y, k);
+	vector<Node<T> *> res;
+
+	for (auto it = ids.begin(); it != ids.end(); it++)
+		res.push_back(nodes.at(*it));
+
+	return res;
+}
+
+/**
+ * @brief Finds the nodes within a certain distance of a position, using the spatial index
+ *
+ * @param x - the x coordinate of the position
+ * @param y - the y coordinate of the position
+ * @param radius - the maximum distance
+ * @return the nodes, in no particular order (none if the index wasn't built)
+ */
+template<typename T>
+vector<Node<T> *> Graph<T>::getNodesInRadius(double x, double y, double radius) const {
+
+	vector<unsigned int> ids = this->spatialIndex.inRadius(x, y, radius);
+	vector<Node<T> *> res;
+
+	for (auto it = ids.begin(); it != ids.end(); it++)
+		res.push_back(nodes.at(*it));
+
+	return res;
+}
+
+/**
+ * @brief Finds the nodes inside a rectangle, borders included, using the spatial index
+ *
+ * @param minX - the smallest x coordinate of the rectangle
+ * @param minY - the smallest y coordinate of the rectangle
+ * @param maxX - the biggest x coordinate of the rectangle
+ * @param maxY - the biggest y coordinate of the rectangle
+ * @return the nodes, in no particular order (none if the index wasn't built)
+ */
+template<typename T>
+vector<Node<T> *> Graph<T>::getNodesInRectangle(double minX, double minY, double maxX, double maxY) const {
+
+	vector<unsigned int> ids = this->spatialIndex.inRectangle(minX, minY, maxX, maxY);
+	vector<Node<T> *> res;
+
+	for (auto it = ids.begin(); it != ids.end(); it++)
+		res.push_back(nodes.at(*it));
+
+	return res;
+}
+
+/**
+ * @brief Runs a task over the range [0, size[, split in small slices shared by several threads
+ *
+ * @param size - the size of the range
+ * @param numThreads - the number of threads
+ * @param task - called with the beginning and the end of each slice, must be safe to run concurrently
+ */
+template<typename T>
+template<typename Task>
+void Graph<T>::parallelFor(unsigned int size, unsigned int numThreads, Task task) {
+
+	const unsigned int sliceSize = 256;
+	atomic<unsigned int> nextSlice(0);
+
+	auto worker = [&]() {
+		unsigned int begin;
+		while ((begin = nextSlice.fetch_add(sliceSize)) < size)
+			task(begin, min(begin + sliceSize, size));
+	};
+
+	vector<thread> threads;
+	for (unsigned int i = 1; i < numThreads; i++)
+		threads.push_back(thread(worker));
+
+	worker();
+
+	for (auto it = threads.begin(); it != threads.end(); it++)
+		it->join();
+}
+
+/**
+ * @brief Finds the shortest walk from a node to every node it can walk to
+ * Only uses its own memory, so it can run in several threads at once
+ *
+ * @param source - the ID of the node
+ * @param walkGraph - the walk edges of each node, as destiny ID and length
+ * @return the ID of each node reached, except the source, with the length of the walk
+ */
+template<typename T>
+vector<pair<unsigned int, double> > Graph<T>::getWalkClosure(unsigned int source,
+		const vector<vector<pair<unsigned int, double> > > & walkGraph) const {
+
+	unordered_map<unsigned int, double> length;
+	priority_queue<pair<double, unsigned int>, vector<pair<double, unsigned int> >,
+			greater<pair<double, unsigned int> > > q;
+
+	length[source] = 0;
+	q.push(pair<double, unsigned int>(0, source));
 
-	vector<T> getPath(Node<T> * dest) const;
+	vector<pair<unsigned int, double> > res;
 
-	vector<Node<T>*> getDetailedPath(Node<T> * dest) const;
+	while (!q.empty()) {
+		pair<double, unsigned int> v = q.top();
+		q.pop();
 
-// ---- Dijkstra Algorithms ----
-	Node<T> * dijkstra_heap(Node<T> * startNode, Node<T> * endNode);
+		if (v.first > length[v.second])
+			continue;
 
-	Node<T> * dijkstra_queue(Node<T> * startNode, Node<T> * endNode);
-	Node<T> * dijkstra_queue_NO_WALK(Node<T> * startNode, Node<T> * endNode);
-	Node<T> * dijkstra_queue_TRANSBORDS(Node<T> * startNode, Node<T> * endNode,
-			int maxNum);
-	Node<T> * dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
-			double walk_distance);
+		if (v.second != source)
+			res.push_back(pair<unsigned int, double>(v.second, v.first));
 
-	// Print in the screen
-	void presentPath(vector<Node<T>*> invertedPath);
+		for (auto it = walkGraph[v.second].begin(); it != walkGraph[v.second].end(); it++) {
+			auto w = length.find(it->first);
 
-// ---- A Star Algorithms ----
-	Node<T> * A_Star(Node<T> * startNode, Node<T> * endNode);
-};
+			if (w == length.end() || w->second > v.first + it->second) {
+				length[it->first] = v.first + it->second;
+				q.push(pair<double, unsigned int>(v.first + it->second, it->first));
+			}
+		}
+	}
+
+	return res;
+}
 
 /**
- * @brief Checks which nodes of the graph are an interface for the different types of transports.
+ * @brief Adds walk edges between every pair of nodes closer than a certain distance
  *
- * By interface, we mean a single stop where the user can catch the bus or subway.
- * There will be a certain time of exchanging between them.
+ * The edges have the straight line distance between the nodes as weight, like the ones loaded from the files,
+ * so they take their time from WALK_TIME_MULTIPLIER. Pairs that already have a walk edge are left as they are.
+ * The nodes are split among several threads, that only read the graph; the edges are added in the end.
  *
+ * With the transitive closure, every node also gets a walk edge to each node it could reach by a sequence
+ * of walks (with the length of the shortest one). In dense areas it can add a lot of edges.
+ *
+ * Must be called before contractChains(), that relies on which stops can be reached walking.
+ *
+ * @param radius - the maximum (straight line) distance of the walk edges
+ * @param transitiveClosure - true to also add the walk edges of the transitive closure
+ * @param numThreads - the number of threads, 0 to use one per processor core
+ * @return the number of edges added
  */
 template<typename T>
-void Graph<T>::findInterfaces() {
+unsigned int Graph<T>::generateFootpaths(double radius, bool transitiveClosure, unsigned int numThreads) {
+	TRACE_SCOPE("generateFootpaths", "preprocess");
 
-	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
+	if (this->spatialIndex.size() != nodes.size())
+		buildSpatialIndex();
 
-		set<string> types;
+	if (numThreads == 0)
+		numThreads = max(1u, thread::hardware_concurrency());
 
-		for (auto i = (*it)->getEdges().begin(); i != (*it)->getEdges().end();
-				i++) {
+	// the walk edges of each node, as destiny ID and length: first the existing ones, then the new ones
+	vector<vector<pair<unsigned int, double> > > walkGraph(nodes.size());
+	vector<unsigned int> numExisting(nodes.size());
 
-			if (i->getType() != WALK) {
-				types.insert(i->getType());
+	parallelFor(nodes.size(), numThreads, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			vector<pair<unsigned int, double> > & walks = walkGraph[i];
+			Node<T> * node = nodes[i];
 
-				if (types.size() > 1) {
-					(*it)->setTransbordTime(DEFAULT_TRANSBORD_TIME);
-					types.clear();
-					break;
+			for (auto it = node->getEdges().begin(); it != node->getEdges().end(); it++)
+				if (it->getType() == WALK)
+					walks.push_back(pair<unsigned int, double>(it->getDestiny()->getId(), it->getLength()));
+
+			numExisting[i] = walks.size();
+
+			vector<unsigned int> nearby = this->spatialIndex.inRadius(node->getX(), node->getY(), radius);
+
+			for (auto it = nearby.begin(); it != nearby.end(); it++) {
+				bool exists = *it == i;
+				for (unsigned int j = 0; j < numExisting[i] && !exists; j++)
+					exists = walks[j].first == *it;
+
+				if (!exists) {
+					double dx = node->getX() - nodes[*it]->getX();
+					double dy = node->getY() - nodes[*it]->getY();
+					walks.push_back(pair<unsigned int, double>(*it, sqrt(dx * dx + dy * dy)));
 				}
 			}
-
 		}
+	});
 
-		types.clear();
+	vector<vector<pair<unsigned int, double> > > closure;
+
+	if (transitiveClosure) {
+		closure.resize(nodes.size());
 
+		parallelFor(nodes.size(), numThreads, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				vector<pair<unsigned int, double> > reached = getWalkClosure(i, walkGraph);
+
+				// the existing walk edges are kept as they are
+				for (auto it = reached.begin(); it != reached.end(); it++) {
+					bool exists = false;
+					for (unsigned int j = 0; j < numExisting[i] && !exists; j++)
+						exists = walkGraph[i][j].first == it->first;
+
+					if (!exists)
+						closure[i].push_back(*it);
+				}
+			}
+		});
 	}
 
-}
+	unsigned int added = 0;
 
-/**
- * @brief Returns a node by its ID
- * 
- * @tparam T 
- * @param ID Node ID
- * @return Node<T>* A pointer to the node
- * @throw out_of_range If the node doesn't exist
- */
-template<typename T>
-Node<T> * Graph<T>::getNodeByID(unsigned int ID) const {
-	return this->nodes.at(ID);
+	for (unsigned int i = 0; i < nodes.size(); i++) {
+		vector<pair<unsigned int, double> > & walks = walkGraph[i];
+		auto first = walks.begin() + numExisting[i];
+
+		if (transitiveClosure) {
+			walks = closure[i];
+			first = walks.begin();
+		}
+
+		nodes[i]->reserveEdges(nodes[i]->getNumberOfEdges() + (walks.end() - first));
+
+		for (auto it = first; it != walks.end(); it++) {
+			nodes[i]->addEdge(Edge<T>(nodes[it->first], it->second, WALK, WALK));
+			added++;
+		}
+	}
+
+	return added;
 }
 
 /**
@@ -675,8 +1899,7 @@ Graph<T>::Graph() {
  */
 template<typename T>
 Graph<T>::~Graph() {
-	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++)
-		delete (*it);
+	// the nodes themselves are destroyed with nodeArena
 	nodes.clear();
 }
 
@@ -689,7 +1912,9 @@ Graph<T>::~Graph() {
  */
 template<typename T>
 void Graph<T>::addNode(T nodeData, int x, int y) {
-	this->nodes.push_back(new Node<T>(nodeData, nodes.size(), x, y));
+	this->originalIDs.push_back(currentIDs.size());
+	this->currentIDs.push_back(nodes.size());
+	this->nodes.push_back(nodeArena.create<Node<T>>(nodeData, nodes.size(), x, y));
 }
 
 /**
@@ -728,7 +1953,7 @@ vector<Node<T> *> Graph<T>::getNodes() const {
 }
 
 template<typename T>
-map<string, set<unsigned int>> Graph<T>::getStationsByLine() const {
+const map<string, set<unsigned int>> & Graph<T>::getStationsByLine() const {
 	return this->listStationsByLine;
 }
 
@@ -831,14 +2056,20 @@ struct compareDistance {
  *
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<typename T>
-Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode) {
+template<typename Stats>
+Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode, Stats && stats) {
+	TRACE_SCOPE("dijkstra_heap", "search");
 
-	vector<Node<T> *> path = { };
+	searchArena.reset();
+	vector<Node<T> *, ArenaAllocator<Node<T> *> > path = vector<Node<T> *, ArenaAllocator<Node<T> *> >(
+			ArenaAllocator<Node<T> *>(searchArena));
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(DBL_MAX);
 		(*it)->clearLastNode();
@@ -846,6 +2077,7 @@ Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode) {
 
 	startNode->setDistance(0);
 	path.push_back(startNode);
+	stats.insert(path.size());
 
 //making the heap, since it only has one element does not need the function
 	make_heap(path.begin(), path.end());
@@ -855,19 +2087,28 @@ Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode) {
 	double new_distance;
 	double old_distance;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!path.empty()) {
 
 		//the miminum value is always in the top
 		v = path.front();
 
 		//putting the min value (considered the max since we swap the operator) in the back
-		pop_heap(path.begin(), path.end());
+		pop_heap(path.begin(), path.end(), compareDistance<T>());
 
 		//removing it
 		path.pop_back();
+		stats.settle();
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
 			new_distance = v->getDistance() + it->getWeight();
 			old_distance = w->getDistance();
@@ -876,10 +2117,14 @@ Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode) {
 
 				w->setDistance(new_distance);
 				w->setLastNode(v);
+				w->setLastVia(it->getVia());
 
 				if (old_distance == DBL_MAX) {  //aka is not in the path
 					path.push_back(w);
+					stats.insert(path.size());
 				}
+				else
+					stats.decreaseKey();
 
 				make_heap(path.begin(), path.end(), compareDistance<T>());
 
@@ -896,36 +2141,47 @@ Node<T> * Graph<T>::dijkstra_heap(Node<T> * startNode, Node<T> * endNode) {
  *
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<class T>
-Node<T> * Graph<T>::A_Star(Node<T> * startNode, Node<T> * endNode) {
+template<typename Stats>
+Node<T> * Graph<T>::A_Star(Node<T> * startNode, Node<T> * endNode, Stats && stats) {
+	TRACE_SCOPE("A_Star", "search");
 
 	//initial setup to compare by distance
 	Node<T>::sortByDistance = true;
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(DBL_MAX);
 		(*it)->clearLastNode();
 		(*it)->setVisited(false);
 		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
 		(*it)->setPrice(0);
 	}
 
 	startNode->setDistance(0);
 	startNode->setLastConnection("FIRST");
-	MutablePriorityQueue<Node<T> > q;
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
 	q.insert(startNode);
+	stats.insert(q.size());
 
 	Node<T> * v;
 	Node<T> * w;
 	double old_distance;
 	double new_distance;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!q.empty()) {
 
 		v = q.extractMin();
+		stats.settle();
 
 		if (v->getId() == endNode->getId()) {
 			endNode->setDistance(
@@ -937,40 +2193,54 @@ Node<T> * Graph<T>::A_Star(Node<T> * startNode, Node<T> * endNode) {
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
 			old_distance = w->getDistance();
 			new_distance = (v->getDistance() + it->getWeight())
 					- v->euclidianDistance(endNode)
 					+ w->euclidianDistance(endNode);
 
+			/*
+			 * adding the transbord time if he changed the type of vehicle
+			 * ignoring walking; before the comparison, so a node never gets a longer distance
+			 */
+			if (v->getLastTypeConnection() != it->getType()
+					&& v->getLastTypeConnection() != WALK
+					&& it->getType() != WALK) {
+				new_distance += v->getTransbordTime();
+			}
+
 			if (old_distance > new_distance) {
 
 				/*updating the prices
 				 * not important for the queue since it's taking distance as the operator
 				 */
-				if (v->getLastConnection() != it->getEdgeConnection())
+				if (!sameRide)
 					w->setPrice(v->getPrice() + it->getPriceWeight());
 
 				else
 					w->setPrice(v->getPrice());
 
-				/*
-				 * adding the transbord time if he changed the type of vehicle
-				 * ignoring walking
-				 */
-				if (v->getLastTypeConnection() != it->getType()
-						&& v->getLastTypeConnection() != WALK
-						&& it->getType() != WALK) {
-					new_distance += v->getTransbordTime();
-				}
-
 				w->setDistance(new_distance);
 				w->setLastNode(v);
-				w->setLastConnection(it->getEdgeConnection());
-				if (!w->getVisited())
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
+				// a node already out of the queue is put back in, as decreaseKey() only works on the nodes in the queue
+				// (with the transbord time in the comparison, it only happens in A_Star, past an edge faster than its estimate)
+				if (!w->getVisited() || w->queueIndex == 0) {
 					q.insert(w);
-				else
+					stats.insert(q.size());
+				}
+				else {
 					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
 
 				w->setVisited(true);
 
@@ -987,74 +2257,98 @@ Node<T> * Graph<T>::A_Star(Node<T> * startNode, Node<T> * endNode) {
  *
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<class T>
-Node<T> * Graph<T>::dijkstra_queue(Node<T> * startNode, Node<T> * endNode) {
+template<typename Stats>
+Node<T> * Graph<T>::dijkstra_queue(Node<T> * startNode, Node<T> * endNode, Stats && stats) {
+	TRACE_SCOPE("dijkstra_queue", "search");
 
 //initial setup to compare by distance
 	Node<T>::sortByDistance = true;
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(DBL_MAX);
 		(*it)->clearLastNode();
 		(*it)->setVisited(false);
 		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
 		(*it)->setPrice(0);
 	}
 
 	startNode->setDistance(0);
 	startNode->setLastConnection("FIRST");
-	MutablePriorityQueue<Node<T> > q;
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
 	q.insert(startNode);
+	stats.insert(q.size());
 
 	Node<T> * v;
 	Node<T> * w;
 	double old_distance;
 	double new_distance;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!q.empty()) {
 
 		v = q.extractMin();
+		stats.settle();
 
 		if (v->getId() == endNode->getId())
 			break;
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
 			old_distance = w->getDistance();
 			new_distance = v->getDistance() + it->getWeight();
 
+			/*
+			 * adding the transbord time if he changed the type of vehicle
+			 * ignoring walking; before the comparison, so a node never gets a longer distance
+			 */
+			if (v->getLastTypeConnection() != it->getType()
+					&& v->getLastTypeConnection() != WALK
+					&& it->getType() != WALK) {
+				new_distance += v->getTransbordTime();
+			}
+
 			if (old_distance > new_distance) {
 
 				/*updating the prices
 				 * not important for the queue since it's taking distance as the operator
 				 */
-				if (v->getLastConnection() != it->getEdgeConnection())
+				if (!sameRide)
 					w->setPrice(v->getPrice() + it->getPriceWeight());
 
 				else
 					w->setPrice(v->getPrice());
 
-				/*
-				 * adding the transbord time if he changed the type of vehicle
-				 * ignoring walking
-				 */
-				if (v->getLastTypeConnection() != it->getType()
-						&& v->getLastTypeConnection() != WALK
-						&& it->getType() != WALK) {
-					new_distance += v->getTransbordTime();
-				}
-
 				w->setDistance(new_distance);
 				w->setLastNode(v);
-				w->setLastConnection(it->getEdgeConnection());
-				if (!w->getVisited())
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
+				// put back in the queue if it had already left it, see A_Star()
+				if (!w->getVisited() || w->queueIndex == 0) {
 					q.insert(w);
-				else
+					stats.insert(q.size());
+				}
+				else {
 					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
 
 				w->setVisited(true);
 
@@ -1071,79 +2365,103 @@ Node<T> * Graph<T>::dijkstra_queue(Node<T> * startNode, Node<T> * endNode) {
  *
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<class T>
+template<typename Stats>
 Node<T> * Graph<T>::dijkstra_queue_NO_WALK(Node<T> * startNode,
-		Node<T> * endNode) {
+		Node<T> * endNode, Stats && stats) {
+	TRACE_SCOPE("dijkstra_queue_NO_WALK", "search");
 
 //initial setup to compare by distance
 	Node<T>::sortByDistance = true;
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(DBL_MAX);
 		(*it)->clearLastNode();
 		(*it)->setVisited(false);
 		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
 		(*it)->setPrice(0);
 	}
 
 	startNode->setDistance(0);
 	startNode->setLastConnection("FIRST");
-	MutablePriorityQueue<Node<T> > q;
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
 	q.insert(startNode);
+	stats.insert(q.size());
 
 	Node<T> * v;
 	Node<T> * w;
 	double old_distance;
 	double new_distance;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!q.empty()) {
 
 		v = q.extractMin();
+		stats.settle();
 
 		if (v->getId() == endNode->getId())
 			break;
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			if (it->getType() == WALK)
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
 			old_distance = w->getDistance();
 			new_distance = v->getDistance() + it->getWeight();
 
-			if (it->getType() == WALK)
-				continue;
+			/*
+			 * adding the transbord time if he changed the type of vehicle
+			 * ignoring walking; before the comparison, so a node never gets a longer distance
+			 */
+			if (v->getLastTypeConnection() != it->getType()
+					&& v->getLastTypeConnection() != WALK
+					&& it->getType() != WALK) {
+				new_distance += v->getTransbordTime();
+			}
 
 			if (old_distance > new_distance) {
 
 				/*updating the prices
 				 * not important for the queue since it's taking distance as the operator
 				 */
-				if (v->getLastConnection() != it->getEdgeConnection())
+				if (!sameRide)
 					w->setPrice(v->getPrice() + it->getPriceWeight());
 
 				else
 					w->setPrice(v->getPrice());
 
-				/*
-				 * adding the transbord time if he changed the type of vehicle
-				 * ignoring walking
-				 */
-				if (v->getLastTypeConnection() != it->getType()
-						&& v->getLastTypeConnection() != WALK
-						&& it->getType() != WALK) {
-					new_distance += v->getTransbordTime();
-				}
-
 				w->setDistance(new_distance);
 				w->setLastNode(v);
-				w->setLastConnection(it->getEdgeConnection());
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
 
-				if (!w->getVisited())
+				// put back in the queue if it had already left it, see A_Star()
+				if (!w->getVisited() || w->queueIndex == 0) {
 					q.insert(w);
-				else
+					stats.insert(q.size());
+				}
+				else {
 					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
 
 				w->setVisited(true);
 			}
@@ -1163,22 +2481,27 @@ Node<T> * Graph<T>::dijkstra_queue_NO_WALK(Node<T> * startNode,
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
  * @param maxNum - the maximum allowed number of transports exchanges
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<class T>
+template<typename Stats>
 Node<T> * Graph<T>::dijkstra_queue_TRANSBORDS(Node<T> * startNode,
-		Node<T> * endNode, int maxNum) {
+		Node<T> * endNode, int maxNum, Stats && stats) {
+	TRACE_SCOPE("dijkstra_queue_TRANSBORDS", "search");
 
 //initial setup to compare by distance
 	Node<T>::sortByDistance = true;
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(DBL_MAX);
 		(*it)->clearLastNode();
 		(*it)->setVisited(false);
 		(*it)->setNumTransbords(INT_MAX);
 		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
 		(*it)->setPrice(0);
 	}
 
@@ -1186,24 +2509,36 @@ Node<T> * Graph<T>::dijkstra_queue_TRANSBORDS(Node<T> * startNode,
 	startNode->setNumTransbords(-1);
 	startNode->setLastConnection("FIRST");
 
-	MutablePriorityQueue<Node<T> > q;
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
 	q.insert(startNode);
+	stats.insert(q.size());
 
 	Node<T> * v;
 	Node<T> * w;
 	double old_distance;
 	double new_distance;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!q.empty()) {
 
 		v = q.extractMin();
+		stats.settle();
 
 		if (v->getId() == endNode->getId())
 			break;
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
 			old_distance = w->getDistance();
 			new_distance = v->getDistance() + it->getWeight();
 
@@ -1212,7 +2547,7 @@ Node<T> * Graph<T>::dijkstra_queue_TRANSBORDS(Node<T> * startNode,
 			/*if the method of transport used or the line has changed
 			 * must add another "transbordo"
 			 */
-			if (v->getLastConnection() != it->getEdgeConnection() && it->getType() != WALK) {
+			if (!sameRide && it->getType() != WALK) {
 
 				currentTransbords++;
 			}
@@ -1221,36 +2556,43 @@ Node<T> * Graph<T>::dijkstra_queue_TRANSBORDS(Node<T> * startNode,
 				continue;
 			}
 
+			/*
+			 * adding the transbord time if he changed the type of vehicle
+			 * ignoring walking; before the comparison, so a node never gets a longer distance
+			 */
+			if (v->getLastTypeConnection() != it->getType()
+					&& v->getLastTypeConnection() != WALK
+					&& it->getType() != WALK) {
+				new_distance += v->getTransbordTime();
+			}
+
 			if (old_distance > new_distance) {
 
 				/*updating the prices
 				 * not important for the queue since it's taking distance as the operator
 				 */
-				if (v->getLastConnection() != it->getEdgeConnection())
+				if (!sameRide)
 					w->setPrice(v->getPrice() + it->getPriceWeight());
 
 				else
 					w->setPrice(v->getPrice());
 
-				/*
-				 * adding the transbord time if he changed the type of vehicle
-				 * ignoring walking
-				 */
-				if (v->getLastTypeConnection() != it->getType()
-						&& v->getLastTypeConnection() != WALK
-						&& it->getType() != WALK) {
-					new_distance += v->getTransbordTime();
-				}
-
 				w->setDistance(new_distance);
 				w->setLastNode(v);
-				w->setLastConnection(it->getEdgeConnection());
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
 				w->setNumTransbords(currentTransbords);
 
-				if (!w->getVisited())
+				// put back in the queue if it had already left it, see A_Star()
+				if (!w->getVisited() || w->queueIndex == 0) {
 					q.insert(w);
-				else
+					stats.insert(q.size());
+				}
+				else {
 					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
 
 				w->setVisited(true);
 			}
@@ -1268,22 +2610,27 @@ Node<T> * Graph<T>::dijkstra_queue_TRANSBORDS(Node<T> * startNode,
  * @param startNode - the beginning Node of the path
  * @param endNode - the end Node of the path
  * @param walk_time - maximum allowed distance
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
  *
  * @return Node * - the final Node of the path, so we can walk it back to get the best path
  */
 template<class T>
+template<typename Stats>
 Node<T> * Graph<T>::dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
-		double walk_time) {
+		double walk_time, Stats && stats) {
+	TRACE_SCOPE("dijkstra_queue_PRICE", "search");
 
 //initial setup to compare by distance
 	Node<T>::sortByDistance = false;
 
+	stats.reset(this->nodes.size());
 	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
 		(*it)->setDistance(0);
 		(*it)->clearLastNode();
 		(*it)->setVisited(false);
 		(*it)->setNumTransbords(INT_MAX);
 		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
 		(*it)->setPrice(DBL_MAX);
 		(*it)->setWalkedTime(0);
 	}
@@ -1292,28 +2639,40 @@ Node<T> * Graph<T>::dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
 	startNode->setNumTransbords(-1);
 	startNode->setLastConnection("FIRST");
 
-	MutablePriorityQueue<Node<T> > q;
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
 	q.insert(startNode);
+	stats.insert(q.size());
 
 	Node<T> * v;
 	Node<T> * w;
 	double old_price;
 	double new_price;
 
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = !startNode->isContracted() && !endNode->isContracted();
+
 	while (!q.empty()) {
 
 		v = q.extractMin();
+		stats.settle();
 
 		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
 
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
 			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
 			old_price = w->getPrice();
 			new_price = v->getPrice();
 
 			double time_walked = v->getWalkedTime();
 
 
-			if (v->getLastConnection() != it->getEdgeConnection())
+			if (!sameRide)
 				new_price += it->getPriceWeight();
 
 			if (it->getType() == WALK)
@@ -1340,12 +2699,19 @@ Node<T> * Graph<T>::dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
 
 				w->setPrice(new_price);
 				w->setLastNode(v);
-				w->setLastConnection(it->getEdgeConnection());
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
 
-				if (!w->getVisited())
+				// put back in the queue if it had already left it, see A_Star()
+				if (!w->getVisited() || w->queueIndex == 0) {
 					q.insert(w);
-				else
+					stats.insert(q.size());
+				}
+				else {
 					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
 
 				w->setVisited(true);
 			}
@@ -1355,18 +2721,207 @@ Node<T> * Graph<T>::dijkstra_queue_PRICE(Node<T> * startNode, Node<T> * endNode,
 	return endNode;
 }
 
+/**
+ * @brief Calculates the fastest trip between two positions given by coordinates, implementing Dijkstra, using a mutable priority queue
+ *
+ * The trip starts by walking to one of the stations nearest to the departure position, and ends by walking
+ * from one of the stations nearest to the arrival position, so the search starts from all the first ones at once
+ * (each with the time it takes to walk there) and picks the last one with the best total time.
+ * Needs the spatial index (see buildSpatialIndex()).
+ *
+ * @param startX - the x coordinate of the departure
+ * @param startY - the y coordinate of the departure
+ * @param endX - the x coordinate of the arrival
+ * @param endY - the y coordinate of the arrival
+ * @param numStations - the number of stations considered around each position
+ * @param stats - the statistics policy, called at each step of the search (see SearchStats.h)
+ *
+ * @return Node * - the arrival station, so we can walk it back to get the best path (the walk to the arrival position
+ * isn't included in its distance), or NULL if no station can be reached
+ */
+template<class T>
+template<typename Stats>
+Node<T> * Graph<T>::dijkstra_queue_LOCATIONS(double startX, double startY, double endX, double endY,
+		unsigned int numStations, Stats && stats) {
+	TRACE_SCOPE("dijkstra_queue_LOCATIONS", "search");
+
+//initial setup to compare by distance
+	Node<T>::sortByDistance = true;
+
+	stats.reset(this->nodes.size());
+	for (auto it = this->nodes.begin(); it != this->nodes.end(); it++) {
+		(*it)->setDistance(DBL_MAX);
+		(*it)->clearLastNode();
+		(*it)->setVisited(false);
+		(*it)->setLastConnection("NOT");
+		(*it)->setLastLines(LineSet());
+		(*it)->setPrice(0);
+	}
+
+	vector<Node<T> *> startNodes = getNearestNodes(startX, startY, numStations);
+	vector<Node<T> *> endNodes = getNearestNodes(endX, endY, numStations);
+
+	searchArena.reset();
+	SearchQueue q = SearchQueue(ArenaAllocator<Node<T> *>(searchArena));
+
+	// searches that start or end inside a contracted chain can't jump over it
+	bool useShortcuts = true;
+
+	for (auto it = startNodes.begin(); it != startNodes.end(); it++) {
+		(*it)->setDistance((*it)->getWalkTime(startX, startY));
+		(*it)->setLastConnection("FIRST");
+		(*it)->setVisited(true);
+		q.insert(*it);
+		stats.insert(q.size());
+		useShortcuts = useShortcuts && !(*it)->isContracted();
+	}
+
+	for (auto it = endNodes.begin(); it != endNodes.end(); it++)
+		useShortcuts = useShortcuts && !(*it)->isContracted();
+
+	Node<T> * v;
+	Node<T> * w;
+	double old_distance;
+	double new_distance;
+
+	Node<T> * arrival = NULL;
+	double arrivalTime = DBL_MAX;
+
+	while (!q.empty()) {
+
+		v = q.extractMin();
+		stats.settle();
+
+		// no station left can be reached (let alone walked from) before the best arrival
+		if (v->getDistance() >= arrivalTime)
+			break;
+
+		if (find(endNodes.begin(), endNodes.end(), v) != endNodes.end()
+				&& v->getDistance() + v->getWalkTime(endX, endY) < arrivalTime) {
+			arrival = v;
+			arrivalTime = v->getDistance() + v->getWalkTime(endX, endY);
+		}
+
+		for (auto it = v->getEdges().begin(); it != v->getEdges().end(); it++) {
+
+			if (it->isSkipped(useShortcuts))
+				continue;
+
+			stats.relax();
+
+			w = it->getDestiny();
+			bool sameRide = it->continuesRide(v);
+			old_distance = w->getDistance();
+			new_distance = v->getDistance() + it->getWeight();
+
+			/*
+			 * adding the transbord time if he changed the type of vehicle
+			 * ignoring walking; before the comparison, so a node never gets a longer distance
+			 */
+			if (v->getLastTypeConnection() != it->getType()
+					&& v->getLastTypeConnection() != WALK
+					&& it->getType() != WALK) {
+				new_distance += v->getTransbordTime();
+			}
+
+			if (old_distance > new_distance) {
+
+				/*updating the prices
+				 * not important for the queue since it's taking distance as the operator
+				 */
+				if (!sameRide)
+					w->setPrice(v->getPrice() + it->getPriceWeight());
+
+				else
+					w->setPrice(v->getPrice());
+
+				w->setDistance(new_distance);
+				w->setLastNode(v);
+				w->setLastVia(it->getVia());
+				w->setLastConnection(it->getEdgeConnection(v));
+				w->setLastLines(it->getRideLines(v));
+				// put back in the queue if it had already left it, see A_Star()
+				if (!w->getVisited() || w->queueIndex == 0) {
+					q.insert(w);
+					stats.insert(q.size());
+				}
+				else {
+					q.decreaseKey(w);
+					stats.decreaseKey();
+				}
+
+				w->setVisited(true);
+
+			}
+		}
+	}
+
+	return arrival;
+}
+
+/**
+ * @brief Puts back, in the path to a certain Node, the stops skipped by shortcut edges
+ * Each skipped stop gets the search information it would have if the search had settled it,
+ * so the stops of the graph are changed
+ *
+ * @param dest - the destiny Node
+ */
+template<class T>
+void Graph<T>::unpackShortcuts(Node<T> * dest) {
+
+	while (dest->getLastNode() != NULL) {
+
+		const vector<Node<T> *> * via = dest->getLastVia();
+		Node<T> * origin = dest->getLastNode();
+
+		if (via != NULL) {
+			Node<T> * next = dest;
+
+			// the stops are rebuilt from the end of the chain, subtracting the edges from the distance
+			for (auto it = via->rbegin(); it != via->rend(); it++) {
+				Node<T> * stop = *it;
+
+				double weight = 0;
+				for (auto e = stop->getEdges().begin(); e != stop->getEdges().end(); e++)
+					if (e->getDestiny() == next && !e->isShortcut())
+						weight = e->getWeight();
+
+				stop->setDistance(next->getDistance() - weight);
+				stop->setPrice(dest->getPrice());
+				stop->setNumTransbords(dest->getNumTransbords());
+				stop->setWalkedTime(dest->getWalkedTime());
+				stop->setLastConnection(dest->getLastConnection());
+				stop->setLastLines(dest->getLastLines());
+				stop->setVisited(true);
+
+				next->setLastNode(stop);
+				next->setLastVia(NULL);
+				next = stop;
+			}
+
+			next->setLastNode(origin);
+			next->setLastVia(NULL);
+		}
+
+		dest = origin;
+	}
+}
+
 /**
  * @brief get the path to a certain Node
+ * Changes the nodes of the path, as the shortcuts on it are unpacked
  *
  * @param dest - the destiny Node
  *
  * @return the vector with the full path, ordered
  */
 template<class T>
-vector<T> Graph<T>::getPath(Node<T> * dest) const {
+vector<T> Graph<T>::getPath(Node<T> * dest) {
 
 	vector<T> res;
 
+	unpackShortcuts(dest);
+
 	while (dest->getLastNode() != NULL) {
 		res.push_back(dest->getInfo());
 		dest = dest->getLastNode();
@@ -1379,15 +2934,21 @@ vector<T> Graph<T>::getPath(Node<T> * dest) const {
 /**
  * @brief Gives detailed Information about the path to take
  *
+ * Changes the nodes of the path: where the search only knows the set of lines the traveller may be on,
+ * the line picked for the ride becomes the node's last connection
+ *
  * @param dest - the destiny Node
  *
  * @return a vector with the path reversed
  */
 template<class T>
-vector<Node<T>*> Graph<T>::getDetailedPath(Node<T> * dest) const {
+vector<Node<T>*> Graph<T>::getDetailedPath(Node<T> * dest) {
+	TRACE_SCOPE("getDetailedPath", "path");
 
 	vector<Node<T>*> invertedPath;
 
+	unpackShortcuts(dest);
+
 	// If there is no way to travel with the constraints, return a vector only with the destiny
 	if (dest->getLastNode() == NULL) {
 		invertedPath.push_back(dest);
@@ -1399,6 +2960,30 @@ vector<Node<T>*> Graph<T>::getDetailedPath(Node<T> * dest) const {
 		dest = dest->getLastNode();
 	}
 
+	/*
+	 * along edges shared by several lines, the search only knows the set of lines the traveller may be on,
+	 * so pick (from the end) a single line for each ride
+	 */
+	const LineRegistry & registry = LineRegistry::instance();
+	unsigned int line = MAX_LINES;
+
+	for (auto it = invertedPath.begin(); it != invertedPath.end(); it++) {
+		const LineSet & lines = (*it)->getLastLines();
+
+		if (lines.none()) {
+			line = MAX_LINES;
+			continue;
+		}
+
+		if (line >= MAX_LINES || !lines.test(line)) {
+			line = registry.findIndex((*it)->getLastConnection());
+			if (line >= MAX_LINES || !lines.test(line))
+				line = getFirstLine(lines);
+		}
+
+		(*it)->setLastConnection(registry.getConnection(line));
+	}
+
 	return invertedPath;
 }
 
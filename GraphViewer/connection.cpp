@@ -1,11 +1,19 @@
 #include "connection.h"
+#include "../Trace.h"
+
+// queued bytes that trigger a flush; the answers to that many messages fit in the socket buffers
+static const size_t FLUSH_SIZE = 64 * 1024;
+
+// messages the async queue holds before sendMsg() has to wait for the writer thread
+static const size_t QUEUE_SIZE = 16 * 1024;
 
 void myerror(string msg) {
   printf("%s\n", msg.c_str());
   exit(-1);
 }
 
-Connection::Connection(short port) {
+Connection::Connection(short port) : buffered(false), unanswered(0), inStart(0), inEnd(0),
+    queue(QUEUE_SIZE), stopping(false), failed(false), queued(0), answered(0) {
 #ifdef __linux__
   struct sockaddr_in echoServAddr; /* Echo server address */
   struct  hostent  *ptrh;
@@ -53,22 +61,165 @@ Connection::Connection(short port) {
 #endif
 }
 
+void Connection::sendAll(const string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    int res = send(sock, data.c_str() + sent, data.size() - sent, 0);
+    if (res < 0)
+      myerror("Unable to send");
+    sent += res;
+  }
+}
+
+Connection::~Connection() {
+  setAsync(false);
+}
+
 bool Connection::sendMsg(string msg) {
-  int res = send(sock, msg.c_str(), msg.size(), 0);
-  if (res < 0) 
-    myerror("Unable to send");
+  if (writer.joinable()) {
+    queued++;
+    if (!queue.push(std::move(msg))) {
+      // the queue is full: sleep until the writer takes a batch from it
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      wakeCond.notify_one();
+      wakeCond.wait(lock, [this, &msg] { return queue.push(std::move(msg)); });
+    }
+    wakeCond.notify_one();
+    return true;
+  }
+
+  if (buffered) {
+    outBuffer += msg;
+    unanswered++;
+    if (outBuffer.size() >= FLUSH_SIZE)
+      return flush();
+    return true;
+  }
+
+  sendAll(msg);
   string answer = readLine();
   return answer == "ok";
 }
 
+bool Connection::flush() {
+  bool ok = true;
+
+  if (!outBuffer.empty()) {
+    sendAll(outBuffer);
+    outBuffer.clear();
+  }
+
+  for (; unanswered > 0; unanswered--)
+    if (readLine() != "ok")
+      ok = false;
+
+  return ok;
+}
+
+void Connection::setBuffered(bool buffered) {
+  if (this->buffered && !buffered)
+    flush();
+  this->buffered = buffered;
+}
+
+bool Connection::isBuffered() const {
+  return buffered;
+}
+
+void Connection::setAsync(bool async) {
+  if (async == writer.joinable())
+    return;
+
+  if (async) {
+    flush();
+    stopping = false;
+    writer = std::thread(&Connection::writeLoop, this);
+  }
+  else {
+    sync();
+    stopping = true;
+    wakeCond.notify_one();
+    writer.join();
+  }
+}
+
+bool Connection::isAsync() const {
+  return writer.joinable();
+}
+
+bool Connection::sync() {
+  if (!writer.joinable())
+    return flush();
+
+  TRACE_SCOPE("Connection::sync", "viewer");
+  std::unique_lock<std::mutex> lock(wakeMutex);
+  wakeCond.notify_one();
+  wakeCond.wait(lock, [this] { return answered.load(std::memory_order_acquire) >= queued; });
+  lock.unlock();
+
+  return !failed.exchange(false);
+}
+
+void Connection::writeLoop() {
+  string batch, msg;
+
+  while (true) {
+    int count = 0;
+    batch.clear();
+    {
+      // popped under the lock, so a sendMsg() waiting for room can't miss it
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      while (batch.size() < FLUSH_SIZE && queue.pop(msg)) {
+        batch += msg;
+        count++;
+      }
+
+      if (count == 0) {
+        if (stopping)
+          return;
+        // a push may come between the check and the wait, so don't sleep for long
+        wakeCond.wait_for(lock, std::chrono::milliseconds(1));
+        continue;
+      }
+    }
+    wakeCond.notify_one();
+
+    // the writer thread's own trace: how long the viewer takes with each batch
+    TRACE_SCOPE("Connection::send", "viewer");
+    sendAll(batch);
+    for (int i = 0; i < count; i++)
+      if (readLine() != "ok")
+        failed = true;
+
+    // the answers are counted under the lock, so a sync() waiting for them can't miss it
+    {
+      std::lock_guard<std::mutex> lock(wakeMutex);
+      answered.fetch_add(count, std::memory_order_release);
+    }
+    wakeCond.notify_one();
+  }
+}
+
 string Connection::readLine() {
-  string msg;  
-  char ch;
+  string msg;
   while (true) {
-    recv(sock, &ch, 1, 0);
-    if (ch == '\n')
-      break;
-    msg.push_back(ch);
+    if (inStart == inEnd) {
+      int received = recv(sock, inBuffer, sizeof(inBuffer), 0);
+      if (received <= 0)
+        return msg;
+      inStart = 0;
+      inEnd = received;
+    }
+
+    const char *end = (const char *) memchr(inBuffer + inStart, '\n', inEnd - inStart);
+    if (end == NULL) {
+      msg.append(inBuffer + inStart, inEnd - inStart);
+      inStart = inEnd;
+    }
+    else {
+      msg.append(inBuffer + inStart, end - (inBuffer + inStart));
+      inStart = end - inBuffer + 1;
+      return msg;
+    }
   }
-  return msg;
 }
@@ -16,21 +16,61 @@
 
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "spscqueue.h"
 
 using namespace std;
 
 class Connection {
  public:
   Connection(short port);
+  ~Connection();
 
   bool sendMsg(string msg);
   string readLine();
+
+  // In buffered mode, sendMsg() only queues the message: the queue is sent in
+  // large writes, and the answers read together, by flush() (or when it is full)
+  void setBuffered(bool buffered);
+  bool isBuffered() const;
+  bool flush();
+
+  // In async mode, sendMsg() only puts the message in a lock-free queue and
+  // returns: a writer thread sends the queue in large writes and reads the
+  // answers. sync() waits until every message sent before it was answered.
+  // flush() returns at once in this mode, the writer doesn't wait for it.
+  // Both sendMsg() and sync() must be called from the same thread.
+  void setAsync(bool async);
+  bool isAsync() const;
+  bool sync();
  private: 
 #ifdef __linux__
   int sock;
 #else
   SOCKET sock;
 #endif
+
+  bool buffered;
+  string outBuffer;        // messages queued, not sent yet
+  int unanswered;          // messages queued or sent whose answer wasn't read yet
+  char inBuffer[4096];     // bytes received, not read yet
+  int inStart, inEnd;
+
+  SPSCQueue<string> queue;      // messages for the writer thread
+  std::thread writer;
+  std::atomic<bool> stopping;
+  std::atomic<bool> failed;      // some answer since the last sync() wasn't "ok"
+  unsigned long long queued;     // messages put in the queue (only used by the caller)
+  std::atomic<unsigned long long> answered;   // messages whose answer was read by the writer
+  std::mutex wakeMutex;          // for the writer to sleep while the queue is empty, and the caller
+  std::condition_variable wakeCond;  // while it is full or until sync(); each one wakes the other
+
+  void sendAll(const string &data);
+  void writeLoop();
 };
 
 #endif
@@ -16,7 +16,13 @@ GraphViewer::GraphViewer(int width, int height, bool dynamic, int port_n) {
 	initialize(width, height, dynamic, port_n);
 }
 
+GraphViewer::~GraphViewer() {
+	// the Connection stops its writer thread
+	delete con;
+}
+
 void GraphViewer::initialize(int width, int height, bool dynamic, int port_n) {
+	this->con = NULL;
 	this->width = width;
 	this->height = height;
 	this->isDynamic = dynamic;
@@ -90,7 +96,8 @@ bool GraphViewer::closeWindow() {
 	char buff[200];
 	sprintf(buff, "closeWindow\n");
 	string str(buff);
-	return con->sendMsg(str);
+	bool ok = con->sendMsg(str);
+	return con->sync() && ok;
 }
 
 bool GraphViewer::addNode(int id) {
@@ -263,5 +270,22 @@ bool GraphViewer::setEdgeFlow(int id, int flow) {
 }
 
 bool GraphViewer::rearrange() {
-	return con->sendMsg("rearrange\n");
+	bool ok = con->sendMsg("rearrange\n");
+	return con->flush() && ok;
+}
+
+void GraphViewer::setBuffered(bool buffered) {
+	con->setBuffered(buffered);
+}
+
+bool GraphViewer::flush() {
+	return con->flush();
+}
+
+void GraphViewer::setAsync(bool async) {
+	con->setAsync(async);
+}
+
+bool GraphViewer::sync() {
+	return con->sync();
 }
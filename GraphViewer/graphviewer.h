@@ -69,6 +69,12 @@ public:
 	 */
 	GraphViewer(int width, int height, bool dynamic, int port_n);
 
+	/**
+	 * Destrutor que termina a ligação ao visualizador. No modo assíncrono, espera que os comandos da fila
+	 * sejam executados e termina a thread que os envia.
+	 */
+	~GraphViewer();
+
 	/**
 	 * Função que cria a janela para visualização.
 	 * Exemplo, para um apontador gv onde foi instanciada a classe GraphViewer:
@@ -310,9 +316,45 @@ public:
 
 	/**
 	 * Função que actualiza a visualização do grafo.
+	 * No modo com buffer, envia também todos os comandos em espera (ver flush()); no modo assíncrono,
+	 * retorna de imediato.
 	 */
 	bool rearrange();
 
+	/**
+	 * Função que liga ou desliga o modo com buffer. Nesse modo, os comandos ficam em espera e são enviados
+	 * juntos, em poucas escritas, e as respostas lidas todas de uma vez, em vez de se esperar pela resposta
+	 * de cada comando. As funções retornam true enquanto o comando está em espera; os erros são indicados
+	 * por flush(). Ao desligar o modo, os comandos em espera são enviados.
+	 *
+	 * @param buffered Booleano que indica se os comandos devem ficar em espera.
+	 */
+	void setBuffered(bool buffered);
+
+	/**
+	 * Função que envia os comandos em espera (no modo com buffer) e lê as suas respostas.
+	 *
+	 * @return true se todos os comandos foram executados com sucesso.
+	 */
+	bool flush();
+
+	/**
+	 * Função que liga ou desliga o modo assíncrono. Nesse modo, as funções apenas colocam o comando numa fila
+	 * e retornam de imediato; uma thread própria envia os comandos da fila e lê as respostas, pelo que quem
+	 * chama nunca espera pelo visualizador. Os erros são indicados por sync(). Ao desligar o modo, espera-se
+	 * que todos os comandos da fila sejam executados.
+	 *
+	 * @param async Booleano que indica se os comandos devem ser enviados por outra thread.
+	 */
+	void setAsync(bool async);
+
+	/**
+	 * Função que espera que todos os comandos já dados sejam executados (no modo assíncrono ou com buffer).
+	 *
+	 * @return true se todos os comandos foram executados com sucesso desde o último sync().
+	 */
+	bool sync();
+
 #ifdef __linux__
 	static pid_t procId;
 #endif
@@ -0,0 +1,50 @@
+#ifndef _SPSC_QUEUE_
+#define _SPSC_QUEUE_
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// The producer only writes tail and the consumer only writes head, so neither needs a lock:
+// a slot is published by the release store of tail, and given back by the release store of head.
+template <typename T>
+class SPSCQueue {
+ public:
+  // capacity is rounded up to a power of two
+  explicit SPSCQueue(size_t capacity) : head(0), tail(0) {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  // called only by the producer; false if the queue is full
+  bool push(T &&value) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == slots.size())
+      return false;
+    slots[t & mask] = std::move(value);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // called only by the consumer; false if the queue is empty
+  bool pop(T &value) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+      return false;
+    value = std::move(slots[h & mask]);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  std::vector<T> slots;
+  size_t mask;
+  alignas(64) std::atomic<size_t> head;   // next slot to pop
+  alignas(64) std::atomic<size_t> tail;   // next slot to push
+};
+
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include "InfoLoader.h"
+#include "Trace.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -13,10 +14,11 @@
 
 using namespace std;
 
-void loadNodes(Graph<string> & grafo) {
+void loadNodes(Graph<string> & grafo, const string & filename) {
+	TRACE_SCOPE("loadNodes", "load");
 
 	string line;
-	ifstream file("nos.txt");
+	ifstream file(filename);
 
 	if (!file.is_open()) {
 		cout << "error opening file...\n";
@@ -46,13 +48,14 @@ void loadNodes(Graph<string> & grafo) {
 	file.close();
 }
 
-void loadEdges(Graph<string> & grafo) {
+void loadEdges(Graph<string> & grafo, const string & filename) {
+	TRACE_SCOPE("loadEdges", "load");
 
 	// -> ID ARESTA / NODE ID INICIO / NODE ID FINAL / TYPE / LINE
 
 	string line;
 
-	ifstream file("arestas.txt");
+	ifstream file(filename);
 
 	if (!file.is_open()) {
 		cout << "error opening file...\n";
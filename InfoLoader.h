@@ -14,12 +14,14 @@ using namespace std;
  * @brief Loads all the Node information from the file into the graph
  *
  * @param grafo - the Graph into which the information will be loaded to
+ * @param filename - the file, in the format of nos.txt
  */
-void loadNodes(Graph<string> & grafo);
+void loadNodes(Graph<string> & grafo, const string & filename = "nos.txt");
 
 /**
  * @brief Loads all the Edge information from the file into the graph Nodes
  *
  * @param grafo - the Graph into which the information will be loaded to
+ * @param filename - the file, in the format of arestas.txt
  */
-void loadEdges(Graph<string> & grafo);
+void loadEdges(Graph<string> & grafo, const string & filename = "arestas.txt");
@@ -0,0 +1,209 @@
+/*
+ * LineIndex.h
+ * A static two way index between the lines and the stations they serve.
+ *
+ * Both directions are kept in compressed rows: all the lists one after the other in a single vector,
+ * and the position where each one starts in another. The stations of a line and the lines of a station are sorted.
+ */
+
+#ifndef LINEINDEX_H_
+#define LINEINDEX_H_
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief A range of IDs inside one of the vectors of an index, valid while the index isn't built again
+ */
+class IDRange {
+private:
+	const unsigned int * first;
+	const unsigned int * last;
+
+public:
+	IDRange(const unsigned int * first, const unsigned int * last) : first(first), last(last) {}
+
+	const unsigned int * begin() const { return first; }
+	const unsigned int * end() const { return last; }
+	unsigned int size() const { return last - first; }
+	bool empty() const { return first == last; }
+};
+
+/**
+ * @brief Index of the stations of each line and of the lines of each station
+ * Built once, with build(), it must be built again if the lines or the node IDs change
+ *
+ * The lines are numbered by the order of their IDs. Every station has only a few lines,
+ * so telling if a line serves a station is a binary search in a handful of numbers.
+ */
+class LineIndex {
+private:
+	vector<string> lineIDs;				// the ID of each line, sorted
+	vector<unsigned int> lineStarts;	// where the stations of each line start in lineStations (and one past the last)
+	vector<unsigned int> lineStations;	// the node IDs of the stations of each line, sorted
+	vector<unsigned int> stationStarts;	// where the lines of each station start in stationLines (and one past the last)
+	vector<unsigned int> stationLines;	// the lines of each station, sorted
+
+public:
+	LineIndex();
+
+	void build(const map<string, set<unsigned int> > & stationsByLine, unsigned int numStations);
+	void clear();
+	bool empty() const;
+
+	unsigned int getNumLines() const;
+	int getLine(const string & lineID) const;
+	const string & getLineID(unsigned int line) const;
+
+	IDRange getStations(unsigned int line) const;
+	IDRange getLines(unsigned int station) const;
+	bool serves(unsigned int line, unsigned int station) const;
+	bool haveCommonLine(unsigned int station1, unsigned int station2) const;
+	void getCommonLines(unsigned int station1, unsigned int station2, vector<unsigned int> & lines) const;
+};
+
+inline LineIndex::LineIndex() {
+}
+
+/**
+ * @brief Builds the index, replacing the one it had
+ *
+ * @param stationsByLine - the node IDs of the stations of each line
+ * @param numStations - the number of nodes, all IDs are smaller
+ */
+inline void LineIndex::build(const map<string, set<unsigned int> > & stationsByLine, unsigned int numStations) {
+
+	clear();
+
+	// the map is sorted by line ID and each set by node ID
+	for (auto it = stationsByLine.begin(); it != stationsByLine.end(); it++) {
+		lineIDs.push_back(it->first);
+		lineStarts.push_back(lineStations.size());
+		lineStations.insert(lineStations.end(), it->second.begin(), it->second.end());
+	}
+	lineStarts.push_back(lineStations.size());
+
+	// count the lines of each station, then put each line in the first free place of its stations
+	stationStarts.assign(numStations + 1, 0);
+	for (unsigned int station : lineStations)
+		stationStarts.at(station + 1)++;
+	for (unsigned int i = 0; i < numStations; i++)
+		stationStarts[i + 1] += stationStarts[i];
+
+	vector<unsigned int> next(stationStarts.begin(), stationStarts.end() - 1);
+	stationLines.resize(lineStations.size());
+
+	// going through the lines in order leaves the lines of each station sorted
+	for (unsigned int line = 0; line < lineIDs.size(); line++)
+		for (unsigned int i = lineStarts[line]; i < lineStarts[line + 1]; i++)
+			stationLines[next[lineStations[i]]++] = line;
+}
+
+/**
+ * @brief Removes all the lines and stations from the index
+ */
+inline void LineIndex::clear() {
+	lineIDs.clear();
+	lineStarts.clear();
+	lineStations.clear();
+	stationStarts.clear();
+	stationLines.clear();
+}
+
+/**
+ * @brief Tells if the index wasn't built
+ */
+inline bool LineIndex::empty() const {
+	return stationStarts.empty();
+}
+
+/**
+ * @brief Returns the number of lines in the index
+ */
+inline unsigned int LineIndex::getNumLines() const {
+	return lineIDs.size();
+}
+
+/**
+ * @brief Finds the number of a line by its ID
+ *
+ * @param lineID - the ID of the line (e.g. "205")
+ * @return the number of the line, or -1 if there is no such line
+ */
+inline int LineIndex::getLine(const string & lineID) const {
+	auto it = lower_bound(lineIDs.begin(), lineIDs.end(), lineID);
+	if (it == lineIDs.end() || *it != lineID)
+		return -1;
+	return it - lineIDs.begin();
+}
+
+/**
+ * @brief Returns the ID of a line
+ */
+inline const string & LineIndex::getLineID(unsigned int line) const {
+	return lineIDs.at(line);
+}
+
+/**
+ * @brief Returns the node IDs of the stations of a line, sorted
+ */
+inline IDRange LineIndex::getStations(unsigned int line) const {
+	return IDRange(lineStations.data() + lineStarts.at(line), lineStations.data() + lineStarts.at(line + 1));
+}
+
+/**
+ * @brief Returns the lines of a station, sorted (see getLineID())
+ */
+inline IDRange LineIndex::getLines(unsigned int station) const {
+	return IDRange(stationLines.data() + stationStarts.at(station), stationLines.data() + stationStarts.at(station + 1));
+}
+
+/**
+ * @brief Tells if a line serves a station
+ */
+inline bool LineIndex::serves(unsigned int line, unsigned int station) const {
+	IDRange lines = getLines(station);
+	return binary_search(lines.begin(), lines.end(), line);
+}
+
+/**
+ * @brief Tells if some line serves both stations
+ */
+inline bool LineIndex::haveCommonLine(unsigned int station1, unsigned int station2) const {
+	IDRange lines1 = getLines(station1);
+	IDRange lines2 = getLines(station2);
+
+	const unsigned int * it1 = lines1.begin();
+	const unsigned int * it2 = lines2.begin();
+
+	while (it1 != lines1.end() && it2 != lines2.end()) {
+		if (*it1 == *it2)
+			return true;
+		if (*it1 < *it2)
+			it1++;
+		else
+			it2++;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Finds the lines that serve both stations
+ *
+ * @param lines - where the lines are put, sorted (its contents are replaced, its memory is reused)
+ */
+inline void LineIndex::getCommonLines(unsigned int station1, unsigned int station2, vector<unsigned int> & lines) const {
+	IDRange lines1 = getLines(station1);
+	IDRange lines2 = getLines(station2);
+
+	lines.clear();
+	set_intersection(lines1.begin(), lines1.end(), lines2.begin(), lines2.end(), back_inserter(lines));
+}
+
+#endif /* LINEINDEX_H_ */
@@ -6,21 +6,126 @@
  */
 
 #include <iostream>
+#include <cstdlib>
 #include "Graph.h"
 #include "InfoLoader.h"
 #include "menu.h"
+#include "StationIndex.h"
+#include "MapRenderer.h"
+#include "Trace.h"
 #include "GraphViewer/graphviewer.h"
 
 using namespace std;
 
-int main() {
+/**
+ * Options given in the command line
+ */
+struct Options {
+	NodeOrder order = FILE_ORDER;	///< how to renumber the nodes
+	double footpathRadius = 0;		///< distance of the generated walk edges, 0 to generate none
+	bool footpathClosure = false;	///< also generate the transitive closure of the walk edges
+	string renderFile;				///< if given, draw the map to this file (SVG, or DOT if it ends in .dot) and exit
+	string traceFile;				///< if given, trace where the time goes, and write it to this file at the end
+	string nodesFile = "nos.txt";	///< the stations
+	string edgesFile = "arestas.txt";	///< the edges between them
+};
+
+/**
+ * @brief Reads the options given in the command line
+ * Accepted options are --order=hilbert, --order=bfs, --order=dfs, --footpaths=<radius>, --footpaths-closure,
+ * --render=<file>, --trace=<file>, --nodes=<file> and --edges=<file>
+ *
+ * @return the options, with their defaults for the ones not given
+ */
+static Options getOptions(int argc, char *argv[]) {
+	Options options;
+
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+
+		if (option == "--order=hilbert")
+			options.order = HILBERT_ORDER;
+		else if (option == "--order=bfs")
+			options.order = BFS_ORDER;
+		else if (option == "--order=dfs")
+			options.order = DFS_ORDER;
+		else if (option.compare(0, 12, "--footpaths=") == 0)
+			options.footpathRadius = atof(option.substr(12).c_str());
+		else if (option == "--footpaths-closure")
+			options.footpathClosure = true;
+		else if (option.compare(0, 9, "--render=") == 0)
+			options.renderFile = option.substr(9);
+		else if (option.compare(0, 8, "--trace=") == 0)
+			options.traceFile = option.substr(8);
+		else if (option.compare(0, 8, "--nodes=") == 0)
+			options.nodesFile = option.substr(8);
+		else if (option.compare(0, 8, "--edges=") == 0)
+			options.edgesFile = option.substr(8);
+		else
+			cout << "Unknown option " << option << " ignored\n";
+	}
+
+	return options;
+}
+
+/**
+ * @brief Writes the trace to the file given with --trace, if any
+ */
+static void saveTrace(const Options &options) {
+	if (options.traceFile.empty())
+		return;
+
+	stopTracing();
+	if (!writeTrace(options.traceFile))
+		cout << "Unable to write " << options.traceFile << endl;
+}
+
+int main(int argc, char *argv[]) {
 
 	Graph<string> grafo;
+	Options options = getOptions(argc, argv);
 
+	// Chrome trace of the loading, the preprocessing and every request, written when the program ends
+	if (!options.traceFile.empty())
+		startTracing();
 
-	loadNodes(grafo);
-	loadEdges(grafo);
+	loadNodes(grafo, options.nodesFile);
+	loadEdges(grafo, options.edgesFile);
 	grafo.findInterfaces();
 
-	menu(grafo);
+	// walk edges between nearby stations, besides the ones in the files
+	if (options.footpathRadius > 0)
+		grafo.generateFootpaths(options.footpathRadius, options.footpathClosure);
+
+	// lines sharing the same track segment are relaxed as a single edge
+	grafo.collapseParallelEdges();
+
+	// stops in the middle of a single line corridor are jumped over by the searches
+	grafo.contractChains();
+
+	// optional renumbering of the nodes, for a better memory locality
+	grafo.reorderNodes(options.order);
+
+	// nearest stations lookup, for trips between arbitrary positions
+	grafo.buildSpatialIndex();
+
+	// the lines of each station, for the line lookups
+	grafo.buildLineIndex();
+
+	// headless drawing of the map, without the GraphViewer
+	if (!options.renderFile.empty()) {
+		if (!renderMap(grafo, vector<Node<string> *>(), options.renderFile)) {
+			cout << "Unable to write " << options.renderFile << endl;
+			return 1;
+		}
+		saveTrace(options);
+		return 0;
+	}
+
+	// the station names are looked up on every trip
+	StationIndex index(grafo);
+
+	menu(grafo, index);
+
+	saveTrace(options);
 }
@@ -0,0 +1,392 @@
+/**
+ * @brief Drawing of the network, and of the computed trips, straight to SVG or DOT files, without the GraphViewer
+ *
+ * @file MapRenderer.cpp
+ */
+#include "MapRenderer.h"
+#include "GraphViewer/graphviewer.h"
+#include "Trace.h"
+#include <fstream>
+#include <unordered_set>
+#include <set>
+#include <tuple>
+#include <climits>
+#include <cctype>
+#include <cmath>
+
+const static int MAP_MARGIN = 50;			// around the stations, in the units of their coordinates
+const static int STATION_RADIUS = 12;
+const static char DEFAULT_EDGE_COLOR[] = "gray";
+const static double MIN_STATION_PIXELS = 24;	// the smallest distance on the screen between stations drawn
+const static unsigned int MAX_LABELS = 150;		// with more stations drawn, only the interchanges have their name
+const static double LINE_SPACING = 4;			// between the lines drawn side by side along the same edge
+
+string getLineColor(const string &lineID)
+{
+	if (lineID == "B")
+		return RED;
+	else if (lineID == "F")
+		return ORANGE;
+	else if (lineID == "D")
+		return YELLOW;
+	else if (lineID == "401")
+		return GREEN;
+	else if (lineID == "204")
+		return CYAN;
+	else if (lineID == "803")
+		return MAGENTA;
+
+	return "";
+}
+
+string getConnectionLineID(const string &connection)
+{
+	return connection.substr(connection.find(' ') + 1);
+}
+
+/**
+ * @brief The name of a GraphViewer color in SVG and DOT (e.g. "DARK_GRAY" becomes "darkgray")
+ */
+static string getFileColor(const string &color)
+{
+	if (color.empty())
+		return DEFAULT_EDGE_COLOR;
+
+	string res;
+	for (char c : color)
+		if (c != '_')
+			res += tolower(c);
+
+	return res;
+}
+
+/**
+ * @brief A key for the pair of stations of an edge, the same in both directions
+ */
+static unsigned long long getEdgeKey(unsigned int id1, unsigned int id2)
+{
+	if (id1 > id2)
+		swap(id1, id2);
+	return ((unsigned long long) id1 << 32) | id2;
+}
+
+/**
+ * @brief The pairs of consecutive stations of a trip
+ */
+static unordered_set<unsigned long long> getPathEdges(const vector<Node<string> *> &path)
+{
+	unordered_set<unsigned long long> res;
+	for (size_t i = 1; i < path.size(); i++)
+		res.insert(getEdgeKey(path[i - 1]->getId(), path[i]->getId()));
+	return res;
+}
+
+/**
+ * @brief Tells if a station is one of the stations of a trip, by node ID
+ */
+static vector<bool> getPathStations(const Graph<string> &g, const vector<Node<string> *> &path)
+{
+	vector<bool> res(g.getNumNodes(), false);
+	for (Node<string> *n : path)
+		res.at(n->getId()) = true;
+	return res;
+}
+
+static string escapeXML(const string &s)
+{
+	string res;
+	for (char c : s) {
+		if (c == '&')
+			res += "&amp;";
+		else if (c == '<')
+			res += "&lt;";
+		else if (c == '>')
+			res += "&gt;";
+		else if (c == '"')
+			res += "&quot;";
+		else
+			res += c;
+	}
+	return res;
+}
+
+static string escapeDOT(const string &s)
+{
+	string res;
+	for (char c : s) {
+		if (c == '"' || c == '\\')
+			res += '\\';
+		res += c;
+	}
+	return res;
+}
+
+/**
+ * @brief The IDs of the lines that run along an edge, all of them if parallel edges were merged into it
+ */
+static vector<string> getEdgeLines(const Edge<string> &e)
+{
+	const LineRegistry &registry = LineRegistry::instance();
+	vector<string> res;
+
+	for (unsigned int line = 0; line < MAX_LINES; line++)
+		if (e.getLines().test(line))
+			res.push_back(getConnectionLineID(registry.getConnection(line)));
+
+	// a line the registry had no room for is only kept by the edge's connection
+	if (res.empty())
+		res.push_back(getConnectionLineID(e.getEdgeConnection()));
+
+	return res;
+}
+
+/**
+ * @brief Tells if an edge is drawn: the GraphViewer doesn't draw the walk edges, and the shortcuts are drawn as the edges they skip
+ */
+static bool isDrawn(const Edge<string> &e)
+{
+	return e.getType() != WALK && !e.isShortcut();
+}
+
+bool renderSVG(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename)
+{
+	ofstream file(filename);
+	if (!file.is_open())
+		return false;
+
+	const vector<Node<string> *> &nodes = g.getNodes();
+
+	int minX = 0, minY = 0, maxX = 0, maxY = 0;
+	if (!nodes.empty()) {
+		minX = minY = INT_MAX;
+		maxX = maxY = INT_MIN;
+	}
+	for (Node<string> *n : nodes) {
+		minX = min(minX, n->getX());
+		minY = min(minY, n->getY());
+		maxX = max(maxX, n->getX());
+		maxY = max(maxY, n->getY());
+	}
+
+	int width = maxX - minX + 2 * MAP_MARGIN;
+	int height = maxY - minY + 2 * MAP_MARGIN;
+
+	file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	file << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+			<< "\" viewBox=\"" << minX - MAP_MARGIN << " " << minY - MAP_MARGIN << " " << width << " " << height << "\">\n";
+	file << "<rect x=\"" << minX - MAP_MARGIN << "\" y=\"" << minY - MAP_MARGIN << "\" width=\"" << width << "\" height=\"" << height
+			<< "\" fill=\"white\"/>\n";
+
+	// the edges of the lines, under everything else
+	unordered_set<unsigned long long> pathEdges = getPathEdges(path);
+
+	file << "<g stroke-linecap=\"round\">\n";
+	for (Node<string> *n : nodes) {
+		for (const Edge<string> &e : n->getEdges()) {
+			if (!isDrawn(e))
+				continue;
+
+			const Node<string> *dest = e.getDestiny();
+			bool inPath = pathEdges.count(getEdgeKey(n->getId(), dest->getId())) > 0;
+			vector<string> lines = getEdgeLines(e);
+
+			// the lines side by side, across the edge taken from its lowest node, so both directions agree
+			const Node<string> *low = n->getId() < dest->getId() ? n : dest;
+			const Node<string> *high = (low == n) ? dest : n;
+			double dx = high->getX() - low->getX(), dy = high->getY() - low->getY();
+			double length = hypot(dx, dy);
+			double normalX = (length > 0) ? -dy / length : 0, normalY = (length > 0) ? dx / length : 0;
+
+			for (size_t i = 0; i < lines.size(); i++) {
+				double offset = (i - (lines.size() - 1) / 2.0) * LINE_SPACING;
+
+				file << "<line x1=\"" << n->getX() + offset * normalX << "\" y1=\"" << n->getY() + offset * normalY
+						<< "\" x2=\"" << dest->getX() + offset * normalX << "\" y2=\"" << dest->getY() + offset * normalY
+						<< "\" stroke=\"" << getFileColor(getLineColor(lines[i])) << "\" stroke-width=\"" << (inPath ? 10 : 4)
+						<< "\"><title>" << escapeXML(lines[i]) << "</title></line>\n";
+			}
+		}
+	}
+	file << "</g>\n";
+
+	// the trip, including the walks between stations, over the lines
+	if (path.size() > 1) {
+		file << "<polyline fill=\"none\" stroke=\"" << getFileColor(RED) << "\" stroke-opacity=\"0.5\" stroke-width=\"16\" points=\"";
+		for (size_t i = 0; i < path.size(); i++)
+			file << (i == 0 ? "" : " ") << path[i]->getX() << "," << path[i]->getY();
+		file << "\"/>\n";
+	}
+
+	// the stations, over the edges
+	vector<bool> pathStations = getPathStations(g, path);
+
+	file << "<g stroke=\"black\" font-family=\"sans-serif\" font-size=\"14\">\n";
+	for (Node<string> *n : nodes) {
+		string name = escapeXML(n->getInfo());
+
+		file << "<circle id=\"n" << g.getOriginalID(n->getId()) << "\" cx=\"" << n->getX() << "\" cy=\"" << n->getY()
+				<< "\" r=\"" << STATION_RADIUS << "\" fill=\"" << (pathStations[n->getId()] ? getFileColor(RED) : "white")
+				<< "\"><title>" << name << "</title></circle>\n";
+		file << "<text x=\"" << n->getX() + STATION_RADIUS + 2 << "\" y=\"" << n->getY() - STATION_RADIUS - 2
+				<< "\" stroke=\"none\">" << name << "</text>\n";
+	}
+	file << "</g>\n";
+
+	file << "</svg>\n";
+
+	return file.good();
+}
+
+bool renderDOT(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename)
+{
+	ofstream file(filename);
+	if (!file.is_open())
+		return false;
+
+	const vector<Node<string> *> &nodes = g.getNodes();
+	unordered_set<unsigned long long> pathEdges = getPathEdges(path);
+	vector<bool> pathStations = getPathStations(g, path);
+
+	file << "digraph network {\n";
+	file << "\tnode [shape=circle, style=filled, fillcolor=white, fontsize=10];\n";
+
+	// DOT's y grows upwards, the stations' one downwards
+	for (Node<string> *n : nodes) {
+		file << "\tn" << g.getOriginalID(n->getId()) << " [label=\"" << escapeDOT(n->getInfo()) << "\", pos=\""
+				<< n->getX() << "," << -n->getY() << "!\"";
+		if (pathStations[n->getId()])
+			file << ", fillcolor=" << getFileColor(RED);
+		file << "];\n";
+	}
+
+	for (Node<string> *n : nodes) {
+		for (const Edge<string> &e : n->getEdges()) {
+			if (!isDrawn(e))
+				continue;
+
+			const Node<string> *dest = e.getDestiny();
+			bool inPath = pathEdges.count(getEdgeKey(n->getId(), dest->getId())) > 0;
+
+			// one edge per line, DOT draws the parallel ones apart
+			for (const string &line : getEdgeLines(e)) {
+				file << "\tn" << g.getOriginalID(n->getId()) << " -> n" << g.getOriginalID(dest->getId())
+						<< " [color=" << getFileColor(getLineColor(line)) << ", label=\"" << escapeDOT(line) << "\"";
+				if (inPath)
+					file << ", penwidth=4";
+				file << "];\n";
+			}
+		}
+	}
+
+	file << "}\n";
+
+	return file.good();
+}
+
+bool renderMap(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename)
+{
+	TRACE_SCOPE("renderMap", "render");
+
+	const string extension = ".dot";
+
+	if (filename.length() >= extension.length()
+			&& filename.compare(filename.length() - extension.length(), extension.length(), extension) == 0)
+		return renderDOT(g, path, filename);
+
+	return renderSVG(g, path, filename);
+}
+
+Viewport getNetworkBounds(const Graph<string> &g)
+{
+	Viewport res = {0, 0, 0, 0};
+	const vector<Node<string> *> &nodes = g.getNodes();
+
+	if (!nodes.empty()) {
+		res.minX = res.maxX = nodes[0]->getX();
+		res.minY = res.maxY = nodes[0]->getY();
+	}
+	for (Node<string> *n : nodes) {
+		res.minX = min(res.minX, (double) n->getX());
+		res.minY = min(res.minY, (double) n->getY());
+		res.maxX = max(res.maxX, (double) n->getX());
+		res.maxY = max(res.maxY, (double) n->getY());
+	}
+
+	return res;
+}
+
+/**
+ * @brief The number of edges of a station that are drawn, to choose which of the stations close together is drawn
+ */
+static unsigned int getDrawnDegree(const Node<string> *n)
+{
+	unsigned int res = 0;
+	for (const Edge<string> &e : n->getEdges())
+		if (isDrawn(e))
+			res++;
+	return res;
+}
+
+MapView buildMapView(const Graph<string> &g, const Viewport &viewport, int screenWidth, int screenHeight)
+{
+	MapView res;
+
+	vector<Node<string> *> visible = g.getNodesInRectangle(viewport.minX, viewport.minY, viewport.maxX, viewport.maxY);
+
+	// the side of the cells of the map in which a single station is drawn
+	double unitsPerPixel = max((viewport.maxX - viewport.minX) / max(screenWidth, 1),
+			(viewport.maxY - viewport.minY) / max(screenHeight, 1));
+	double cellSize = max(MIN_STATION_PIXELS * unitsPerPixel, 1e-9);
+
+	unordered_map<unsigned long long, pair<unsigned int, unsigned int> > cells;	// cell -> degree and node ID of the station drawn
+	vector<unsigned long long> visibleCells(visible.size());
+
+	for (size_t i = 0; i < visible.size(); i++) {
+		Node<string> *n = visible[i];
+		unsigned long long column = (unsigned long long) floor((n->getX() - viewport.minX) / cellSize);
+		unsigned long long row = (unsigned long long) floor((n->getY() - viewport.minY) / cellSize);
+		visibleCells[i] = (column << 32) | (row & 0xFFFFFFFFULL);
+
+		pair<unsigned int, unsigned int> candidate(getDrawnDegree(n), n->getId());
+		auto it = cells.find(visibleCells[i]);
+		if (it == cells.end())
+			cells.emplace(visibleCells[i], candidate);
+		else if (candidate.first > it->second.first
+				|| (candidate.first == it->second.first && candidate.second < it->second.second))
+			it->second = candidate;
+	}
+
+	for (size_t i = 0; i < visible.size(); i++) {
+		unsigned int drawn = cells.at(visibleCells[i]).second;
+		res.drawnAs[visible[i]->getId()] = drawn;
+		if (drawn == visible[i]->getId())
+			res.stations.push_back(drawn);
+	}
+
+	// the edges between the visible stations, moved to the stations drawn for them
+	set<tuple<unsigned int, unsigned int, string> > segments;
+	for (Node<string> *n : visible) {
+		unsigned int source = res.drawnAs.at(n->getId());
+
+		for (const Edge<string> &e : n->getEdges()) {
+			if (!isDrawn(e))
+				continue;
+
+			auto dest = res.drawnAs.find(e.getDestiny()->getId());
+			if (dest == res.drawnAs.end() || dest->second == source)
+				continue;
+
+			for (const string &line : getEdgeLines(e))
+				if (segments.insert(make_tuple(source, dest->second, line)).second)
+					res.segments.push_back({source, dest->second, line});
+		}
+	}
+
+	// the interchanges are the stations of more than one line (all of them if the line index wasn't built)
+	const LineIndex &lines = g.getLineIndex();
+	bool labelAll = res.stations.size() <= MAX_LABELS || lines.empty();
+	for (unsigned int id : res.stations)
+		res.labeled.push_back(labelAll || lines.getLines(id).size() > 1);
+
+	return res;
+}
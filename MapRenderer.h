@@ -0,0 +1,103 @@
+/**
+ * @brief Drawing of the network, and of the computed trips, straight to SVG or DOT files, without the GraphViewer
+ *
+ * @file MapRenderer.h
+ */
+#ifndef MAPRENDERER_H_
+#define MAPRENDERER_H_
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * @brief The color of a line on the map, the same in the GraphViewer and in the files
+ *
+ * @param lineID The ID of the line
+ * @return The name of the color (one of the GraphViewer's, e.g. "RED"), or an empty string for the default color
+ */
+string getLineColor(const string &lineID);
+
+/**
+ * @brief The ID of the line of a connection, e.g. "204" for "bus 204" (see Node::getLastConnection())
+ */
+string getConnectionLineID(const string &connection);
+
+/**
+ * @brief Draws the network as an SVG image: the stations at their position, and the edges of the lines with their colors
+ * The walk edges and the shortcuts aren't drawn, like in the GraphViewer. It takes a single pass over the graph.
+ *
+ * @param g The graph
+ * @param path The stations of a trip to highlight, in order (e.g. from getDetailedPath()), empty for none
+ * @param filename The file to write
+ * @return true if the file was written
+ */
+bool renderSVG(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename);
+
+/**
+ * @brief Writes the network as a Graphviz DOT file, with the same colors and highlighted trip as renderSVG()
+ * The stations are pinned to their position (render with neato -n)
+ *
+ * @param g The graph
+ * @param path The stations of a trip to highlight, in order, empty for none
+ * @param filename The file to write
+ * @return true if the file was written
+ */
+bool renderDOT(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename);
+
+/**
+ * @brief Draws the network with renderDOT() if the file name ends in ".dot", with renderSVG() otherwise
+ */
+bool renderMap(const Graph<string> &g, const vector<Node<string> *> &path, const string &filename);
+
+/**
+ * @brief A rectangle of the map, in the coordinates of the stations
+ */
+struct Viewport {
+	double minX;
+	double minY;
+	double maxX;
+	double maxY;
+};
+
+/**
+ * @brief The smallest viewport with all the stations of the network
+ */
+Viewport getNetworkBounds(const Graph<string> &g);
+
+/**
+ * @brief What is drawn of the network in a viewport, at the detail its zoom allows
+ */
+struct MapView {
+	struct Segment {
+		unsigned int source;	// node IDs of the stations drawn
+		unsigned int dest;
+		string lineID;
+	};
+
+	vector<unsigned int> stations;	// node IDs of the stations drawn
+	vector<bool> labeled;			// if each station drawn has its name shown
+	vector<Segment> segments;		// the edges of the lines between stations drawn, one per line and direction
+	unordered_map<unsigned int, unsigned int> drawnAs;	// node ID of each station in the viewport -> node ID of the station drawn for it
+};
+
+/**
+ * @brief Chooses what to draw of the network in a viewport, so the amount drawn depends on the screen, not on the network
+ * Only the stations inside the viewport are drawn (found with the spatial index, see Graph::buildSpatialIndex()).
+ * When several stations would be closer than a few pixels on the screen, only the one with most edges is drawn,
+ * and the edges of the others are drawn from it. When many stations are drawn, only the interchanges (see
+ * Graph::buildLineIndex()) have their name.
+ * The walk edges and the shortcuts aren't drawn.
+ *
+ * @param g The graph
+ * @param viewport The part of the map shown
+ * @param screenWidth The width, in pixels, of the window where it is shown
+ * @param screenHeight The height, in pixels, of the window where it is shown
+ * @return The stations and edges to draw
+ */
+MapView buildMapView(const Graph<string> &g, const Viewport &viewport, int screenWidth, int screenHeight);
+
+#endif /* MAPRENDERER_H_ */
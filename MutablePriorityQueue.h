@@ -10,6 +10,7 @@
 #define SRC_MUTABLEPRIORITYQUEUE_H_
 
 #include <vector>
+#include <memory>
 #include <stddef.h>
 
 
@@ -17,40 +18,47 @@ using namespace std;
 
 /**
  * class T must have: (i) accessible field int queueIndex; (ii) operator< defined.
+ * Alloc is the allocator of the heap storage (e.g. an ArenaAllocator, for per-query scratch memory).
  */
 
-template <class T>
+template <class T, class Alloc = allocator<T *> >
 class MutablePriorityQueue {
-	vector<T *> H;
+	vector<T *, Alloc> H;
 	void heapifyUp(unsigned i);
 	void heapifyDown(unsigned i);
 	inline void set(unsigned i, T * x);
 public:
-	MutablePriorityQueue();
+	MutablePriorityQueue(const Alloc & alloc = Alloc());
 	void insert(T * x);
 	T * extractMin();
 	void decreaseKey(T * x);
 	bool empty();
+	unsigned int size();
 };
 
 // Index calculations
 #define parent(i) ((i) >> 1)  /* i / 2 */
 #define leftChild(i) ((i) << 1)  /* i * 2 */
 
-template <class T>
-MutablePriorityQueue<T>::MutablePriorityQueue() {
+template <class T, class Alloc>
+MutablePriorityQueue<T, Alloc>::MutablePriorityQueue(const Alloc & alloc) : H(alloc) {
 	H.push_back(NULL);
 	// indices will be used starting in 1
 	// to facilitate parent/child calculations
 }
 
-template <class T>
-bool MutablePriorityQueue<T>::empty() {
+template <class T, class Alloc>
+bool MutablePriorityQueue<T, Alloc>::empty() {
 	return H.size() == 1;
 }
 
-template <class T>
-T* MutablePriorityQueue<T>::extractMin() {
+template <class T, class Alloc>
+unsigned int MutablePriorityQueue<T, Alloc>::size() {
+	return H.size() - 1;
+}
+
+template <class T, class Alloc>
+T* MutablePriorityQueue<T, Alloc>::extractMin() {
 	auto x = H[1];
 	x->queueIndex = 0;
 	H[1] = H.back();
@@ -60,14 +68,14 @@ T* MutablePriorityQueue<T>::extractMin() {
 	return x;
 }
 
-template <class T>
-void MutablePriorityQueue<T>::insert(T *x) {
+template <class T, class Alloc>
+void MutablePriorityQueue<T, Alloc>::insert(T *x) {
 	H.push_back(x);
 	heapifyUp(H.size()-1);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::heapifyUp(unsigned i) {
+template <class T, class Alloc>
+void MutablePriorityQueue<T, Alloc>::heapifyUp(unsigned i) {
 	auto x = H[i];
 	while (i > 1 && *x < *H[parent(i)]) {
 		set(i, H[parent(i)]);
@@ -76,13 +84,13 @@ void MutablePriorityQueue<T>::heapifyUp(unsigned i) {
 	set(i, x);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::decreaseKey(T *x) {
+template <class T, class Alloc>
+void MutablePriorityQueue<T, Alloc>::decreaseKey(T *x) {
 	heapifyUp(x->queueIndex);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::heapifyDown(unsigned i) {
+template <class T, class Alloc>
+void MutablePriorityQueue<T, Alloc>::heapifyDown(unsigned i) {
 	auto x = H[i];
 	while (true) {
 		unsigned k = leftChild(i);
@@ -98,8 +106,8 @@ void MutablePriorityQueue<T>::heapifyDown(unsigned i) {
 	set(i, x);
 }
 
-template <class T>
-void MutablePriorityQueue<T>::set(unsigned i, T * x) {
+template <class T, class Alloc>
+void MutablePriorityQueue<T, Alloc>::set(unsigned i, T * x) {
 	H[i] = x;
 	x->queueIndex = i;
 }
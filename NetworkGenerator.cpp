@@ -0,0 +1,253 @@
+/**
+ * @brief Generation of synthetic transit networks (subway and bus lines, interchanges and walks), for scaling tests
+ *
+ * @file NetworkGenerator.cpp
+ */
+#include "NetworkGenerator.h"
+#include "Trace.h"
+#include <random>
+#include <fstream>
+#include <unordered_map>
+#include <cmath>
+
+const static double PI = 3.14159265358979323846;
+const static double SUBWAY_TURN = 0.15;		// standard deviation of the change of heading between stops, in radians
+const static double BUS_TURN = 0.5;
+const static double STOP_AREA = 2;			// area around each stop, in squared bus spacings, when the area is fitted
+
+const static char *NAME_PREFIXES[] = { "Rua", "Avenida", "Praca", "Largo", "Estacao", "Travessa", "Alameda", "Bairro" };
+const static char *SYLLABLES[] = { "ca", "sa", "ma", "ri", "to", "lo", "ve", "ra", "bo", "fi", "gu", "ne", "pa", "do", "zi", "mu" };
+
+/**
+ * @brief The stops in buckets of a square grid, to find the ones near a position without looking at all of them
+ */
+class StopGrid {
+private:
+	double cellSize;
+	unordered_map<unsigned long long, vector<unsigned int> > cells;
+
+	long long getCell(double coordinate) const {
+		return (long long) floor(coordinate / cellSize);
+	}
+
+	static unsigned long long getKey(long long column, long long row) {
+		return ((unsigned long long) column << 32) | ((unsigned long long) row & 0xFFFFFFFFULL);
+	}
+
+public:
+	explicit StopGrid(double cellSize) : cellSize(cellSize) {}
+
+	void add(unsigned int id, double x, double y) {
+		cells[getKey(getCell(x), getCell(y))].push_back(id);
+	}
+
+	/**
+	 * @brief Calls f with the ID of every stop in the cells within a distance of a position (some may be farther)
+	 */
+	template<typename F>
+	void forEachNear(double x, double y, double radius, F f) const {
+		for (long long column = getCell(x - radius); column <= getCell(x + radius); column++) {
+			for (long long row = getCell(y - radius); row <= getCell(y + radius); row++) {
+				auto it = cells.find(getKey(column, row));
+				if (it == cells.end())
+					continue;
+				for (unsigned int id : it->second)
+					f(id);
+			}
+		}
+	}
+};
+
+static string getStopName(mt19937 &generator)
+{
+	const unsigned int numPrefixes = sizeof(NAME_PREFIXES) / sizeof(NAME_PREFIXES[0]);
+	const unsigned int numSyllables = sizeof(SYLLABLES) / sizeof(SYLLABLES[0]);
+
+	string res = NAME_PREFIXES[generator() % numPrefixes];
+
+	for (unsigned int word = 0; word < 2; word++) {
+		string w;
+		unsigned int length = 2 + generator() % 3;
+		for (unsigned int i = 0; i < length; i++)
+			w += SYLLABLES[generator() % numSyllables];
+		w[0] = toupper(w[0]);
+		res += " " + w;
+	}
+
+	return res;
+}
+
+static double getDistance(const GeneratedNetwork::Stop &stop, double x, double y)
+{
+	return sqrt((stop.x - x) * (stop.x - x) + (stop.y - y) * (stop.y - y));
+}
+
+NetworkParameters getNetworkParameters(unsigned int numStops, unsigned int seed)
+{
+	NetworkParameters res;
+
+	double defaultStops = res.numSubwayLines * res.stopsPerSubwayLine + res.numBusLines * res.stopsPerBusLine;
+	double scale = numStops / defaultStops;
+
+	res.numSubwayLines = max(1.0, round(res.numSubwayLines * scale));
+	res.numBusLines = max(1.0, round(res.numBusLines * scale));
+	res.seed = seed;
+
+	return res;
+}
+
+/**
+ * @brief Adds a line to the network, both ways
+ */
+static void generateLine(GeneratedNetwork &network, StopGrid &grid, mt19937 &generator, const NetworkParameters &parameters,
+		double areaSize, bool subway, const string &lineID)
+{
+	uniform_real_distribution<double> unit(0, 1);
+
+	double spacing = subway ? parameters.subwaySpacing : parameters.busSpacing;
+	unsigned int numStops = subway ? parameters.stopsPerSubwayLine : parameters.stopsPerBusLine;
+	normal_distribution<double> turn(0, subway ? SUBWAY_TURN : BUS_TURN);
+
+	double x, y, heading;
+	if (subway) {
+		// from somewhere near the border, towards the center
+		double angle = 2 * PI * unit(generator);
+		x = areaSize / 2 + cos(angle) * areaSize * 0.45;
+		y = areaSize / 2 + sin(angle) * areaSize * 0.45;
+		heading = angle + PI + turn(generator);
+	}
+	else {
+		x = areaSize * unit(generator);
+		y = areaSize * unit(generator);
+		heading = 2 * PI * unit(generator);
+	}
+
+	vector<unsigned int> lineStops;
+
+	for (unsigned int i = 0; i < numStops; i++) {
+
+		// the closest stop of another line, if this one stops there
+		int stop = -1;
+		if (unit(generator) < parameters.interchangeDensity) {
+			double best = spacing / 2;
+			grid.forEachNear(x, y, spacing / 2, [&](unsigned int id) {
+				double distance = getDistance(network.stops[id], x, y);
+				if (distance <= best && find(lineStops.begin(), lineStops.end(), id) == lineStops.end()
+						&& (distance < best || stop < 0 || (int) id < stop)) {
+					best = distance;
+					stop = id;
+				}
+			});
+		}
+
+		if (stop < 0) {
+			stop = network.stops.size();
+			network.stops.push_back({ getStopName(generator), (int) round(x), (int) round(y) });
+			grid.add(stop, x, y);
+		}
+
+		if (!lineStops.empty()) {
+			string type = subway ? SUBWAY : BUS;
+			network.links.push_back({ lineStops.back(), (unsigned int) stop, type, lineID });
+			network.links.push_back({ (unsigned int) stop, lineStops.back(), type, lineID });
+		}
+		lineStops.push_back(stop);
+
+		// the next stop, turning back into the area at its borders
+		heading += turn(generator);
+		double step = spacing * (0.7 + 0.6 * unit(generator));
+		x += cos(heading) * step;
+		y += sin(heading) * step;
+
+		if (x < 0 || x > areaSize) {
+			heading = PI - heading;
+			x = max(0.0, min(areaSize, x));
+		}
+		if (y < 0 || y > areaSize) {
+			heading = -heading;
+			y = max(0.0, min(areaSize, y));
+		}
+	}
+}
+
+GeneratedNetwork generateNetwork(const NetworkParameters &parameters)
+{
+	TRACE_SCOPE("generateNetwork", "load");
+
+	GeneratedNetwork network;
+	mt19937 generator(parameters.seed);
+
+	double numStops = (double) parameters.numSubwayLines * parameters.stopsPerSubwayLine
+			+ (double) parameters.numBusLines * parameters.stopsPerBusLine;
+	double areaSize = parameters.areaSize;
+	if (areaSize <= 0)
+		areaSize = max(1.0, sqrt(numStops * STOP_AREA) * parameters.busSpacing);
+
+	double cellSize = max(1.0, max(parameters.walkRadius, min(parameters.subwaySpacing, parameters.busSpacing) / 2));
+	StopGrid grid(cellSize);
+
+	network.stops.reserve(numStops);
+
+	for (unsigned int i = 0; i < parameters.numSubwayLines; i++)
+		generateLine(network, grid, generator, parameters, areaSize, true, "M" + to_string(i + 1));
+
+	for (unsigned int i = 0; i < parameters.numBusLines; i++)
+		generateLine(network, grid, generator, parameters, areaSize, false, to_string(100 + i));
+
+	// walks between the stops close to each other
+	if (parameters.walkRadius > 0) {
+		for (unsigned int i = 0; i < network.stops.size(); i++) {
+			const GeneratedNetwork::Stop &stop = network.stops[i];
+
+			grid.forEachNear(stop.x, stop.y, parameters.walkRadius, [&](unsigned int id) {
+				if (id > i && getDistance(network.stops[id], stop.x, stop.y) <= parameters.walkRadius) {
+					network.links.push_back({ i, id, WALK, WALK });
+					network.links.push_back({ id, i, WALK, WALK });
+				}
+			});
+		}
+	}
+
+	return network;
+}
+
+void addNetwork(Graph<string> &g, const GeneratedNetwork &network)
+{
+	unsigned int first = g.getNumNodes();
+
+	for (const GeneratedNetwork::Stop &stop : network.stops)
+		g.addNode(stop.name, stop.x, stop.y);
+
+	for (const GeneratedNetwork::Link &link : network.links) {
+		const GeneratedNetwork::Stop &source = network.stops[link.source];
+		const GeneratedNetwork::Stop &dest = network.stops[link.dest];
+
+		// the same weight loadEdges() gives
+		double weight = sqrt(pow(dest.x - source.x, 2) + pow(dest.y - source.y, 2));
+
+		if (link.type == BUS)
+			g.addBusEdge(first + link.source, first + link.dest, weight, link.lineID);
+		else if (link.type == SUBWAY)
+			g.addSubwayEdge(first + link.source, first + link.dest, weight, link.lineID);
+		else
+			g.addWalkEdge(first + link.source, first + link.dest, weight, link.lineID);
+	}
+}
+
+bool writeNetwork(const GeneratedNetwork &network, const string &nodesFilename, const string &edgesFilename)
+{
+	ofstream nodesFile(nodesFilename);
+	ofstream edgesFile(edgesFilename);
+	if (!nodesFile.is_open() || !edgesFile.is_open())
+		return false;
+
+	for (const GeneratedNetwork::Stop &stop : network.stops)
+		nodesFile << stop.name << ";" << stop.x << ";" << stop.y << "\n";
+
+	for (size_t i = 0; i < network.links.size(); i++) {
+		const GeneratedNetwork::Link &link = network.links[i];
+		edgesFile << i << ";" << link.source << ";" << link.dest << ";" << link.type << ";" << link.lineID << "\n";
+	}
+
+	return nodesFile.good() && edgesFile.good();
+}
@@ -0,0 +1,89 @@
+/**
+ * @brief Generation of synthetic transit networks (subway and bus lines, interchanges and walks), for scaling tests
+ *
+ * @file NetworkGenerator.h
+ */
+#ifndef NETWORKGENERATOR_H_
+#define NETWORKGENERATOR_H_
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief What the generated network looks like
+ */
+struct NetworkParameters {
+	unsigned int numSubwayLines = 4;
+	unsigned int numBusLines = 20;
+	unsigned int stopsPerSubwayLine = 20;
+	unsigned int stopsPerBusLine = 30;
+	double subwaySpacing = 800;		///< mean distance between consecutive stops of a subway line
+	double busSpacing = 300;		///< mean distance between consecutive stops of a bus line
+	double interchangeDensity = 0.5;	///< chance that a line stops at a stop of another line close to where it passes
+	double walkRadius = 150;		///< stops closer than this are joined by walk edges, 0 for none
+	double areaSize = 0;			///< the side of the square the lines run in, 0 to fit the number of stops
+	unsigned int seed = 1;			///< the same parameters and seed give the same network
+};
+
+/**
+ * @brief Parameters for a network of about a given number of stops, with the proportions of the default ones
+ *
+ * @param numStops The number of stops wanted (less when lines share stops)
+ * @param seed The seed of the network
+ */
+NetworkParameters getNetworkParameters(unsigned int numStops, unsigned int seed = 1);
+
+/**
+ * @brief A network, as in the nos.txt and arestas.txt files
+ */
+struct GeneratedNetwork {
+	struct Stop {
+		string name;
+		int x;
+		int y;
+	};
+
+	struct Link {
+		unsigned int source;	// indexes in stops
+		unsigned int dest;
+		string type;			// SUBWAY, BUS or WALK
+		string lineID;
+	};
+
+	vector<Stop> stops;
+	vector<Link> links;
+};
+
+/**
+ * @brief Generates a network
+ * Each line is a random walk that keeps its heading, with stops at about the line's spacing; the subway lines are
+ * straighter and cross the center. Where a line passes near a stop of another line, it may stop there (an interchange).
+ * Every line runs both ways. Neighbor stops are found in a grid of buckets, so millions of stops take seconds.
+ *
+ * @param parameters What the network looks like
+ * @return The stops and the edges
+ */
+GeneratedNetwork generateNetwork(const NetworkParameters &parameters);
+
+/**
+ * @brief Adds a generated network to a graph, as loadNodes() and loadEdges() would from its files
+ *
+ * @param g The graph, the stops get the IDs after its nodes
+ * @param network The network
+ */
+void addNetwork(Graph<string> &g, const GeneratedNetwork &network);
+
+/**
+ * @brief Writes a generated network in the format of nos.txt and arestas.txt
+ *
+ * @param network The network
+ * @param nodesFilename The file of the stops
+ * @param edgesFilename The file of the edges
+ * @return true if both files were written
+ */
+bool writeNetwork(const GeneratedNetwork &network, const string &nodesFilename, const string &edgesFilename);
+
+#endif /* NETWORKGENERATOR_H_ */
@@ -0,0 +1,95 @@
+/*
+ * SearchStats.h
+ * Counters of the work done by a search, collected through a policy given to the Graph's searches.
+ *
+ * The searches call the policy at each step. NoSearchStats, the default, does nothing, and its empty
+ * inline functions are compiled out, so a search without statistics costs the same as before.
+ */
+
+#ifndef SEARCHSTATS_H_
+#define SEARCHSTATS_H_
+
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief The work done by a search
+ */
+struct SearchCounters {
+	unsigned long long resetNodes = 0;		///< nodes whose search fields were reset before the search
+	unsigned long long settled = 0;			///< nodes taken out of the queue
+	unsigned long long relaxed = 0;			///< edges looked at from the settled nodes
+	unsigned long long inserts = 0;			///< nodes put in the queue
+	unsigned long long decreaseKeys = 0;	///< nodes moved up in the queue, after getting a better key
+	unsigned long long maxQueueSize = 0;	///< the most nodes in the queue at the same time
+};
+
+/**
+ * @brief Statistics policy that collects nothing
+ */
+class NoSearchStats {
+public:
+	void reset(unsigned int) {}
+	void insert(unsigned int) {}
+	void decreaseKey() {}
+	void settle() {}
+	void relax() {}
+};
+
+/**
+ * @brief Statistics policy that counts every step of the search
+ * The counters add up over the searches it is given to, until clear()
+ */
+class CountingSearchStats {
+private:
+	SearchCounters counters;
+
+public:
+	/**
+	 * @brief The search reset the fields of the nodes
+	 *
+	 * @param numNodes - the number of nodes reset
+	 */
+	void reset(unsigned int numNodes) {
+		counters.resetNodes += numNodes;
+	}
+
+	/**
+	 * @brief A node was put in the queue
+	 *
+	 * @param queueSize - the size of the queue with it
+	 */
+	void insert(unsigned int queueSize) {
+		counters.inserts++;
+		counters.maxQueueSize = max(counters.maxQueueSize, (unsigned long long) queueSize);
+	}
+
+	void decreaseKey() {
+		counters.decreaseKeys++;
+	}
+
+	void settle() {
+		counters.settled++;
+	}
+
+	void relax() {
+		counters.relaxed++;
+	}
+
+	/**
+	 * @brief Returns the counters of the searches so far
+	 */
+	const SearchCounters & getCounters() const {
+		return counters;
+	}
+
+	/**
+	 * @brief Sets all the counters back to 0
+	 */
+	void clear() {
+		counters = SearchCounters();
+	}
+};
+
+#endif /* SEARCHSTATS_H_ */
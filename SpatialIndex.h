@@ -0,0 +1,248 @@
+/*
+ * SpatialIndex.h
+ * A static 2-d tree over points in the plane, for nearest neighbour, radius and rectangle queries.
+ *
+ * The tree is implicit: the points are kept in a single vector, each subtree is a range of it,
+ * with its splitting point in the middle of the range.
+ */
+
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Index of points (each one with an ID) by their position
+ * Built once, with build(), it must be built again if the points change
+ */
+class SpatialIndex {
+public:
+	struct Point {
+		double x;
+		double y;
+		unsigned int id;
+	};
+
+private:
+	vector<Point> points;
+
+	typedef pair<double, unsigned int> Candidate;	// squared distance, index in points
+
+	void build(unsigned int begin, unsigned int end, bool splitX);
+	void nearest(unsigned int begin, unsigned int end, bool splitX, double x, double y, unsigned int k,
+			priority_queue<Candidate> & best) const;
+	void inRadius(unsigned int begin, unsigned int end, bool splitX, double x, double y, double radius,
+			vector<unsigned int> & res) const;
+	void inRectangle(unsigned int begin, unsigned int end, bool splitX, double minX, double minY, double maxX,
+			double maxY, vector<unsigned int> & res) const;
+
+	static double squaredDistance(const Point & p, double x, double y);
+
+public:
+	SpatialIndex();
+
+	void build(const vector<Point> & points);
+	void clear();
+	bool empty() const;
+	unsigned int size() const;
+
+	vector<unsigned int> nearest(double x, double y, unsigned int k) const;
+	vector<unsigned int> inRadius(double x, double y, double radius) const;
+	vector<unsigned int> inRectangle(double minX, double minY, double maxX, double maxY) const;
+};
+
+inline SpatialIndex::SpatialIndex() {
+}
+
+inline double SpatialIndex::squaredDistance(const Point & p, double x, double y) {
+	return (p.x - x) * (p.x - x) + (p.y - y) * (p.y - y);
+}
+
+/**
+ * @brief Builds the index, replacing the points it had
+ *
+ * @param points - the points to index
+ */
+inline void SpatialIndex::build(const vector<Point> & points) {
+	this->points = points;
+	build(0, this->points.size(), true);
+}
+
+/**
+ * @brief Puts the median of the range (by x or y) in its middle, the smaller points before it
+ * and the bigger ones after it, and does the same to both halves with the other coordinate
+ */
+inline void SpatialIndex::build(unsigned int begin, unsigned int end, bool splitX) {
+
+	if (end - begin <= 1)
+		return;
+
+	unsigned int middle = begin + (end - begin) / 2;
+
+	nth_element(points.begin() + begin, points.begin() + middle, points.begin() + end,
+			[splitX](const Point & a, const Point & b) {
+				return splitX ? a.x < b.x : a.y < b.y;
+			});
+
+	build(begin, middle, !splitX);
+	build(middle + 1, end, !splitX);
+}
+
+/**
+ * @brief Removes all the points from the index
+ */
+inline void SpatialIndex::clear() {
+	points.clear();
+}
+
+/**
+ * @brief Tells if the index has no points
+ */
+inline bool SpatialIndex::empty() const {
+	return points.empty();
+}
+
+/**
+ * @brief Returns the number of points in the index
+ */
+inline unsigned int SpatialIndex::size() const {
+	return points.size();
+}
+
+/**
+ * @brief Finds the k points closest to a position
+ *
+ * @param x - the x coordinate of the position
+ * @param y - the y coordinate of the position
+ * @param k - the number of points wanted
+ * @return the IDs of the points, from the closest to the farthest (less than k if the index is smaller)
+ */
+inline vector<unsigned int> SpatialIndex::nearest(double x, double y, unsigned int k) const {
+
+	priority_queue<Candidate> best;	// the farthest of the k best on top
+
+	if (k > 0)
+		nearest(0, points.size(), true, x, y, k, best);
+
+	vector<unsigned int> res(best.size());
+	for (unsigned int i = best.size(); i > 0; i--) {
+		res[i - 1] = points[best.top().second].id;
+		best.pop();
+	}
+
+	return res;
+}
+
+inline void SpatialIndex::nearest(unsigned int begin, unsigned int end, bool splitX, double x, double y,
+		unsigned int k, priority_queue<Candidate> & best) const {
+
+	if (begin >= end)
+		return;
+
+	unsigned int middle = begin + (end - begin) / 2;
+	const Point & p = points[middle];
+
+	double distance = squaredDistance(p, x, y);
+	if (best.size() < k)
+		best.push(Candidate(distance, middle));
+	else if (distance < best.top().first) {
+		best.pop();
+		best.push(Candidate(distance, middle));
+	}
+
+	// search first the half where the position is, the other one only if it can have closer points
+	double offset = splitX ? x - p.x : y - p.y;
+	bool lowerFirst = offset < 0;
+
+	if (lowerFirst)
+		nearest(begin, middle, !splitX, x, y, k, best);
+	else
+		nearest(middle + 1, end, !splitX, x, y, k, best);
+
+	if (best.size() < k || offset * offset < best.top().first) {
+		if (lowerFirst)
+			nearest(middle + 1, end, !splitX, x, y, k, best);
+		else
+			nearest(begin, middle, !splitX, x, y, k, best);
+	}
+}
+
+/**
+ * @brief Finds all the points within a certain distance of a position
+ *
+ * @param x - the x coordinate of the position
+ * @param y - the y coordinate of the position
+ * @param radius - the maximum distance
+ * @return the IDs of the points, in no particular order
+ */
+inline vector<unsigned int> SpatialIndex::inRadius(double x, double y, double radius) const {
+
+	vector<unsigned int> res;
+	inRadius(0, points.size(), true, x, y, radius, res);
+	return res;
+}
+
+inline void SpatialIndex::inRadius(unsigned int begin, unsigned int end, bool splitX, double x, double y,
+		double radius, vector<unsigned int> & res) const {
+
+	if (begin >= end)
+		return;
+
+	unsigned int middle = begin + (end - begin) / 2;
+	const Point & p = points[middle];
+
+	if (squaredDistance(p, x, y) <= radius * radius)
+		res.push_back(p.id);
+
+	double offset = splitX ? x - p.x : y - p.y;
+
+	// the points before the middle aren't bigger than it, the ones after aren't smaller
+	if (offset <= radius)
+		inRadius(begin, middle, !splitX, x, y, radius, res);
+	if (offset >= -radius)
+		inRadius(middle + 1, end, !splitX, x, y, radius, res);
+}
+
+/**
+ * @brief Finds all the points inside a rectangle, borders included
+ *
+ * @param minX - the smallest x coordinate of the rectangle
+ * @param minY - the smallest y coordinate of the rectangle
+ * @param maxX - the biggest x coordinate of the rectangle
+ * @param maxY - the biggest y coordinate of the rectangle
+ * @return the IDs of the points, in no particular order
+ */
+inline vector<unsigned int> SpatialIndex::inRectangle(double minX, double minY, double maxX, double maxY) const {
+
+	vector<unsigned int> res;
+	inRectangle(0, points.size(), true, minX, minY, maxX, maxY, res);
+	return res;
+}
+
+inline void SpatialIndex::inRectangle(unsigned int begin, unsigned int end, bool splitX, double minX, double minY,
+		double maxX, double maxY, vector<unsigned int> & res) const {
+
+	if (begin >= end)
+		return;
+
+	unsigned int middle = begin + (end - begin) / 2;
+	const Point & p = points[middle];
+
+	if (p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY)
+		res.push_back(p.id);
+
+	double coordinate = splitX ? p.x : p.y;
+
+	// the points before the middle aren't bigger than it, the ones after aren't smaller
+	if ((splitX ? minX : minY) <= coordinate)
+		inRectangle(begin, middle, !splitX, minX, minY, maxX, maxY, res);
+	if ((splitX ? maxX : maxY) >= coordinate)
+		inRectangle(middle + 1, end, !splitX, minX, minY, maxX, maxY, res);
+}
+
+#endif /* SPATIALINDEX_H_ */
@@ -0,0 +1,696 @@
+/**
+ * @brief Index of the station names, to find the stations whose name contains a given text
+ *
+ * @file StationIndex.cpp
+ */
+#include "StationIndex.h"
+#include "stringSearch.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+#include <functional>
+
+const static char NAME_END = '\0'; // separates the names in the text, never part of a pattern
+const static int MAX_PRUNED_DIFF = 2; // biggest edit distance for which the BK-tree prunes enough to pay off
+
+/**
+ * @brief Packs the 3 characters of a text starting at a certain position in a single integer
+ */
+static unsigned int trigramAt(const string & s, unsigned int i) {
+	return ((unsigned char) s[i] << 16) | ((unsigned char) s[i + 1] << 8) | (unsigned char) s[i + 2];
+}
+
+/**
+ * @brief The trigrams of a text, sorted, each one once
+ */
+static vector<unsigned int> getTrigrams(const string & s) {
+
+	vector<unsigned int> res;
+	for (unsigned int i = 0; i + 3 <= s.length(); i++)
+		res.push_back(trigramAt(s, i));
+
+	sort(res.begin(), res.end());
+	res.erase(unique(res.begin(), res.end()), res.end());
+
+	return res;
+}
+
+/**
+ * @brief The stations of the words found in a BK-tree, sorted by node ID, each one with the distance of its word
+ */
+static vector<pair<unsigned int, int> > getStations(const vector<pair<const vector<unsigned int> *, int> > & found) {
+
+	vector<pair<unsigned int, int> > res;
+
+	for (auto it = found.begin(); it != found.end(); it++)
+		for (unsigned int id : *it->first)
+			res.push_back(pair<unsigned int, int>(id, it->second));
+
+	sort(res.begin(), res.end());
+
+	return res;
+}
+
+/**
+ * @brief Adds a new node to the tree, without linking it to its parent
+ *
+ * @return The index of the node
+ */
+unsigned int BKTree::addNode(const string & word, unsigned int id) {
+
+	nodes.push_back(BKNode());
+	nodes.back().word = word;
+	nodes.back().maxChildDistance = 0;
+	nodes.back().ids.push_back(id);
+
+	if (byLength.size() <= word.length())
+		byLength.resize(word.length() + 1);
+	byLength[word.length()].push_back(nodes.size() - 1);
+
+	return nodes.size() - 1;
+}
+
+/**
+ * @brief Adds a word to the tree, or just the station ID if the word is already there
+ *
+ * @param word The word
+ * @param id The ID of the station with that word
+ */
+void BKTree::insert(const string & word, unsigned int id) {
+
+	if (nodes.empty()) {
+		addNode(word, id);
+		return;
+	}
+
+	unsigned int current = 0;
+
+	while (true) {
+		int distance = editDistance(word, nodes[current].word);
+
+		if (distance == 0) {
+			nodes[current].ids.push_back(id);
+			return;
+		}
+
+		unsigned int next = nodes.size();
+		for (auto it = nodes[current].children.begin(); it != nodes[current].children.end(); it++)
+			if (it->first == distance)
+				next = it->second;
+
+		if (next == nodes.size()) {
+			nodes[current].children.push_back(pair<int, unsigned int>(distance, next));
+			nodes[current].maxChildDistance = max(nodes[current].maxChildDistance, distance);
+			addNode(word, id);
+			return;
+		}
+
+		current = next;
+	}
+}
+
+/**
+ * @brief Removes all the words from the tree
+ */
+void BKTree::clear() {
+	nodes.clear();
+	byLength.clear();
+}
+
+/**
+ * @brief Returns the number of (different) words in the tree
+ */
+unsigned int BKTree::size() const {
+	return nodes.size();
+}
+
+/**
+ * @brief Finds the words within a certain edit distance of a query
+ *
+ * @param query The query
+ * @param maxDiff The maximum edit distance
+ * @return The station IDs of each word found, with its distance to the query
+ */
+vector<pair<const vector<unsigned int> *, int> > BKTree::find(string_view query, int maxDiff) const {
+
+	vector<pair<const vector<unsigned int> *, int> > res;
+
+	if (nodes.empty())
+		return res;
+
+	// the distance is symmetric, the query is prepared once and compared to every word visited
+	CompiledPattern compiled(query);
+
+	// with a big maxDiff the tree prunes almost nothing: only the words of a length within maxDiff of the query's are compared
+	if (maxDiff > MAX_PRUNED_DIFF) {
+		size_t firstLength = (query.length() > (size_t) maxDiff) ? query.length() - maxDiff : 0;
+		size_t lastLength = min(byLength.size(), query.length() + maxDiff + 1);
+
+		for (size_t length = firstLength; length < lastLength; length++) {
+			for (unsigned int i : byLength[length]) {
+				int distance = compiled.editDistance(nodes[i].word, maxDiff);
+				if (distance <= maxDiff)
+					res.push_back(pair<const vector<unsigned int> *, int>(&nodes[i].ids, distance));
+			}
+		}
+		return res;
+	}
+
+	vector<unsigned int> toVisit(1, 0);
+
+	while (!toVisit.empty()) {
+		const BKNode & node = nodes[toVisit.back()];
+		toVisit.pop_back();
+
+		// past maxDiff plus the farthest child, the exact distance doesn't matter: no child can be within reach
+		int distance = compiled.editDistance(node.word, maxDiff + node.maxChildDistance);
+
+		if (distance <= maxDiff)
+			res.push_back(pair<const vector<unsigned int> *, int>(&node.ids, distance));
+
+		for (auto it = node.children.begin(); it != node.children.end(); it++)
+			if (abs(it->first - distance) <= maxDiff)
+				toVisit.push_back(it->second);
+	}
+
+	return res;
+}
+
+/**
+ * @brief Finds the words closest to a query, within a certain edit distance, enough of them for k stations:
+ * all the words as close as the one that makes k stations (or all the words within maxDiff, if they are fewer)
+ *
+ * The words are compared by their length, the query's first, as a word can't be closer than the difference
+ * between their lengths. The distance allowed shrinks each time k stations are within a smaller one,
+ * and so does the range of lengths compared.
+ *
+ * @param query The query
+ * @param maxDiff The maximum edit distance
+ * @param k The number of stations
+ * @return The station IDs of each word found, with its distance to the query
+ */
+vector<pair<const vector<unsigned int> *, int> > BKTree::findClosest(string_view query, int maxDiff, unsigned int k) const {
+
+	// within the distance the tree prunes well, walking it is faster
+	if (maxDiff <= MAX_PRUNED_DIFF || k == 0)
+		return find(query, maxDiff);
+
+	CompiledPattern compiled(query);
+
+	vector<pair<const vector<unsigned int> *, int> > found;
+	vector<unsigned int> stations(maxDiff + 1, 0);	// the number of stations of the words found at each distance
+
+	for (int lengthDiff = 0; lengthDiff <= maxDiff; lengthDiff++) {
+		for (int sign : { -1, 1 }) {
+			int length = (int) query.length() + sign * lengthDiff;
+			if (length < 0 || length >= (int) byLength.size() || (lengthDiff == 0 && sign > 0))
+				continue;
+
+			for (unsigned int i : byLength[length]) {
+				int distance = compiled.editDistance(nodes[i].word, maxDiff);
+				if (distance > maxDiff)
+					continue;
+
+				found.push_back(pair<const vector<unsigned int> *, int>(&nodes[i].ids, distance));
+				stations[distance] += nodes[i].ids.size();
+
+				// the smallest distance with k stations within it
+				unsigned int within = 0;
+				for (int d = 0; d <= maxDiff; d++) {
+					within += stations[d];
+					if (within >= k) {
+						maxDiff = d;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// the words found before maxDiff shrank
+	vector<pair<const vector<unsigned int> *, int> > res;
+	for (const pair<const vector<unsigned int> *, int> & word : found)
+		if (word.second <= maxDiff)
+			res.push_back(word);
+
+	return res;
+}
+
+StationIndex::StationIndex() {
+}
+
+/**
+ * @brief Creates the index of all the stations of a graph
+ *
+ * @param g The graph
+ */
+StationIndex::StationIndex(const Graph<string> & g) {
+	build(g);
+}
+
+/**
+ * @brief Builds the index of all the stations of a graph, replacing the one it had
+ *
+ * @param g The graph
+ */
+void StationIndex::build(const Graph<string> & g) {
+	TRACE_SCOPE("StationIndex::build", "preprocess");
+
+	text.clear();
+	nameStarts.clear();
+	stationIDs.clear();
+	stationNames.assign(g.getNumNodes(), "");
+	searchKeys.assign(g.getNumNodes(), "");
+
+	for (Node<string> * station : g.getNodes()) {
+		nameStarts.push_back(text.size());
+		stationIDs.push_back(station->getId());
+		stationNames.at(station->getId()) = station->getInfo();
+		searchKeys.at(station->getId()) = normalize(station->getInfo());
+		text += searchKeys.at(station->getId());
+		text += NAME_END;
+	}
+
+	names.clear();
+	tokens.clear();
+
+	for (unsigned int i = 0; i < stationIDs.size(); i++) {
+		const string & key = searchKeys.at(stationIDs[i]);
+		names.insert(key, stationIDs[i]);
+
+		// the key has no common words, and its words are separated by single spaces
+		for (string_view word : Tokens(key))
+			tokens.insert(string(word), stationIDs[i]);
+	}
+
+	// the (trigram, station) pairs, sorted, become the lists of stations of each trigram
+	vector<pair<unsigned int, unsigned int> > occurrences;
+	for (unsigned int id : stationIDs)
+		for (unsigned int trigram : getTrigrams(searchKeys.at(id)))
+			occurrences.push_back(pair<unsigned int, unsigned int>(trigram, id));
+
+	sort(occurrences.begin(), occurrences.end());
+
+	trigrams.clear();
+	trigramStarts.clear();
+	trigramStations.clear();
+	trigramStations.reserve(occurrences.size());
+
+	for (const pair<unsigned int, unsigned int> & occurrence : occurrences) {
+		if (trigrams.empty() || trigrams.back() != occurrence.first) {
+			trigrams.push_back(occurrence.first);
+			trigramStarts.push_back(trigramStations.size());
+		}
+		trigramStations.push_back(occurrence.second);
+	}
+	trigramStarts.push_back(trigramStations.size());
+
+	completions.build(g);
+
+	suffixes.clear();
+	for (unsigned int i = 0; i < text.size(); i++)
+		if (text[i] != NAME_END)
+			suffixes.push_back(i);
+
+	// a suffix ends with its name, so two suffixes differ at the latest in the separator of the shortest one
+	const char * t = text.c_str();
+	sort(suffixes.begin(), suffixes.end(), [t](unsigned int a, unsigned int b) {
+		return strcmp(t + a, t + b) < 0;
+	});
+}
+
+/**
+ * @brief Returns the number of stations in the index
+ */
+unsigned int StationIndex::getNumStations() const {
+	return stationIDs.size();
+}
+
+/**
+ * @brief Returns the name of a station
+ *
+ * @param id The node ID of the station
+ */
+const string & StationIndex::getStationName(unsigned int id) const {
+	return stationNames.at(id);
+}
+
+/**
+ * @brief Returns the normalized name of a station, the one that is searched
+ *
+ * @param id The node ID of the station
+ */
+const string & StationIndex::getSearchKey(unsigned int id) const {
+	return searchKeys.at(id);
+}
+
+/**
+ * @brief Returns the autocompletion of the station names, to follow a name as it is typed
+ */
+const Autocomplete & StationIndex::getAutocomplete() const {
+	return completions;
+}
+
+/**
+ * @brief Finds the name that a certain position of the text belongs to
+ */
+unsigned int StationIndex::getNameIndex(unsigned int position) const {
+	return upper_bound(nameStarts.begin(), nameStarts.end(), position) - nameStarts.begin() - 1;
+}
+
+/**
+ * @brief Compares the beginning of a suffix with a pattern
+ *
+ * @return 0 if the suffix starts with the pattern, < 0 if it's smaller and > 0 if it's bigger
+ */
+int StationIndex::comparePrefix(unsigned int suffix, const string & pattern) const {
+	return strncmp(text.c_str() + suffix, pattern.c_str(), pattern.size());
+}
+
+/**
+ * @brief Finds the stations whose name contains a text, ignoring the case, the accents and the common words
+ *
+ * Takes O(m log n) to find the range of suffixes starting with the text (m its length, n the size of all names),
+ * plus the number of occurrences.
+ *
+ * @param pattern The text to find
+ * @return The node IDs of the stations, in increasing order, each one once
+ */
+vector<unsigned int> StationIndex::findContaining(const string & pattern) const {
+	return findContainingKey(normalize(pattern));
+}
+
+vector<unsigned int> StationIndex::findContainingKey(const string & key) const {
+
+	vector<unsigned int> res;
+
+	if (key.empty() || key.find(NAME_END) != string::npos)
+		return res;
+
+	auto first = lower_bound(suffixes.begin(), suffixes.end(), key,
+			[this](unsigned int suffix, const string & p) {
+				return comparePrefix(suffix, p) < 0;
+			});
+	auto last = upper_bound(first, suffixes.end(), key,
+			[this](const string & p, unsigned int suffix) {
+				return comparePrefix(suffix, p) > 0;
+			});
+
+	for (auto it = first; it != last; it++)
+		res.push_back(stationIDs[getNameIndex(*it)]);
+
+	// a name can contain the text more than once
+	sort(res.begin(), res.end());
+	res.erase(unique(res.begin(), res.end()), res.end());
+
+	return res;
+}
+
+/**
+ * @brief Finds the stations whose name is within a certain edit distance of a text,
+ * both normalized (without case, accents and common words)
+ *
+ * @param pattern The text
+ * @param maxDiff The maximum edit distance
+ * @return The node IDs of the stations, in increasing order, each one with the distance of its name to the text
+ */
+vector<pair<unsigned int, int> > StationIndex::findApproximate(const string & pattern, int maxDiff) const {
+	return findApproximateKey(normalize(pattern), maxDiff);
+}
+
+vector<pair<unsigned int, int> > StationIndex::findApproximateKey(const string & key, int maxDiff) const {
+	return getStations(names.find(key, maxDiff));
+}
+
+/**
+ * @brief Finds the stations whose name is closest to a normalized text, within a certain edit distance:
+ * all the ones as close as the k-th closest, see BKTree::findClosest()
+ *
+ * @return The node IDs of the stations, in increasing order, each one with the distance of its name to the text
+ */
+vector<pair<unsigned int, int> > StationIndex::findClosestKey(const string & key, int maxDiff, unsigned int k) const {
+	return getStations(names.findClosest(key, maxDiff, k));
+}
+
+/**
+ * @brief Finds the stations with a word in their name within a certain edit distance of some word of a text
+ * The common words in the dictionary of stringSearch.cpp are ignored in the names
+ *
+ * @param pattern The text
+ * @param maxDiff The maximum edit distance between the words
+ * @return The node IDs of the stations, in increasing order, each one once
+ */
+vector<unsigned int> StationIndex::findByToken(const string & pattern, int maxDiff) const {
+	return findByTokenKey(normalize(pattern), maxDiff);
+}
+
+vector<unsigned int> StationIndex::findByTokenKey(const string & key, int maxDiff) const {
+
+	vector<unsigned int> res;
+
+	for (string_view word : Tokens(key)) {
+		vector<pair<const vector<unsigned int> *, int> > found = tokens.find(word, maxDiff);
+		for (auto it = found.begin(); it != found.end(); it++)
+			res.insert(res.end(), it->first->begin(), it->first->end());
+	}
+
+	sort(res.begin(), res.end());
+	res.erase(unique(res.begin(), res.end()), res.end());
+
+	return res;
+}
+
+/**
+ * @brief Finds the stations with some part of their name within a certain edit distance of a text,
+ * both normalized (without case, accents and common words)
+ *
+ * The candidates come from the trigram lists: t distinct trigrams in the text, at most 3 per edit can be lost,
+ * so a station must be in at least t - 3 * maxDiff of their lists. Only the candidates are compared with the text.
+ * When that bound isn't positive (short text, or too many edits), every station is a candidate.
+ *
+ * @param pattern The text
+ * @param maxDiff The maximum edit distance
+ * @return The node IDs of the stations, in increasing order, each one with the distance of the closest part of its name
+ */
+vector<pair<unsigned int, int> > StationIndex::findPartial(const string & pattern, int maxDiff) const {
+	return findPartialKey(normalize(pattern), maxDiff);
+}
+
+vector<pair<unsigned int, int> > StationIndex::findPartialKey(const string & key, int maxDiff) const {
+
+	vector<pair<unsigned int, int> > res;
+
+	if (key.empty())
+		return res;
+
+	vector<unsigned int> keyTrigrams = getTrigrams(key);
+	int minShared = (int) keyTrigrams.size() - 3 * maxDiff;
+
+	vector<unsigned int> candidates;
+
+	if (minShared <= 0) {
+		candidates = stationIDs;
+		sort(candidates.begin(), candidates.end());
+	}
+	else {
+		// the lists of the trigrams of the text that some name has
+		vector<pair<const unsigned int *, const unsigned int *> > lists;
+		for (unsigned int trigram : keyTrigrams) {
+			auto it = lower_bound(trigrams.begin(), trigrams.end(), trigram);
+			if (it != trigrams.end() && *it == trigram) {
+				unsigned int i = it - trigrams.begin();
+				lists.push_back(make_pair(&trigramStations[trigramStarts[i]], &trigramStations[0] + trigramStarts[i + 1]));
+			}
+		}
+
+		// merge the lists, counting how many of them each station is in
+		typedef pair<unsigned int, unsigned int> Head;	// node ID, list
+		priority_queue<Head, vector<Head>, greater<Head> > heads;
+
+		if ((int) lists.size() >= minShared)
+			for (unsigned int l = 0; l < lists.size(); l++)
+				heads.push(Head(*lists[l].first, l));
+
+		while (!heads.empty()) {
+			unsigned int id = heads.top().first;
+			int shared = 0;
+
+			while (!heads.empty() && heads.top().first == id) {
+				unsigned int l = heads.top().second;
+				heads.pop();
+				shared++;
+
+				if (++lists[l].first != lists[l].second)
+					heads.push(Head(*lists[l].first, l));
+			}
+
+			if (shared >= minShared)
+				candidates.push_back(id);
+		}
+	}
+
+	CompiledPattern compiled(key);
+
+	for (unsigned int id : candidates) {
+		int distance = compiled.substringEditDistance(searchKeys.at(id), maxDiff);
+		if (distance <= maxDiff)
+			res.push_back(pair<unsigned int, int>(id, distance));
+	}
+
+	return res;
+}
+
+/**
+ * @brief Suggests the stations that best match a text, merging the exact, approximate, partial and token matches in a single ranking
+ *
+ * The stations whose name contains the text come first, the ones where it's a bigger part of the name before,
+ * then the ones whose name, or some part of it, is close to the text (by edit distance, the whole name first on a tie),
+ * then the ones with a word close to a word of the text.
+ * Each station is scored by its best match. Only the best k are kept while the matches are merged.
+ *
+ * @param query The text
+ * @param k The maximum number of suggestions
+ * @return The suggestions, from the best to the worst (ties by node ID)
+ */
+vector<StationSuggestion> StationIndex::suggestStations(const string & query, unsigned int k) const {
+
+	TRACE_SCOPE("suggestStations", "lookup");
+
+	string key = normalize(query);
+	double queryLength = key.length();
+
+	vector<unsigned int> exact;
+	{
+		TRACE_SCOPE("exact", "lookup");
+		exact = findContainingKey(key);
+	}
+
+	int maxDiff = queryLength * APPROXIMATE_TOLERANCE;
+
+	vector<unsigned int> byToken;
+	{
+		TRACE_SCOPE("token", "lookup");
+		byToken = findByTokenKey(key, TOKEN_MAX_DIFF);
+	}
+
+	// no more edits than the trigram lists can filter, so not every station has to be compared
+	int partialDiff = queryLength * PARTIAL_TOLERANCE;
+	partialDiff = max(0, min(partialDiff, ((int) getTrigrams(key).size() - 1) / 3));
+	vector<pair<unsigned int, int> > partial;
+	{
+		TRACE_SCOPE("partial", "lookup");
+		partial = findPartialKey(key, partialDiff);
+	}
+
+	/*
+	 * A name at distance d scores 1 + d, so it can't be among the best k if k stations score less: the ones
+	 * found so far (an exact match scores under 1, a partial one 1.5 + its distance), or the k closest names
+	 */
+	vector<double> scores(exact.size(), 0);	// only under 1 matters for the exact matches
+	for (auto it = partial.begin(); it != partial.end(); it++)
+		if (!binary_search(exact.begin(), exact.end(), it->first))
+			scores.push_back(1.5 + it->second);
+
+	int approximateDiff = maxDiff;
+	if (k > 0 && scores.size() >= k) {
+		nth_element(scores.begin(), scores.begin() + k - 1, scores.end());
+		approximateDiff = min(maxDiff, (int) floor(scores[k - 1] - 1));
+	}
+
+	vector<pair<unsigned int, int> > approximate;
+	if (approximateDiff >= 0) {
+		TRACE_SCOPE("approximate", "lookup");
+		approximate = findClosestKey(key, approximateDiff, k);
+	}
+
+	// the k best so far, with the worst one on top
+	typedef pair<double, unsigned int> Candidate;	// score, node ID
+	vector<pair<Candidate, SuggestionMatch> > best;
+	best.reserve(k + 1);
+
+	auto worse = [](const pair<Candidate, SuggestionMatch> & a, const pair<Candidate, SuggestionMatch> & b) {
+		return a.first < b.first;
+	};
+
+	// all four lists are sorted by node ID, so they are merged in a single pass
+	auto e = exact.begin();
+	auto a = approximate.begin();
+	auto p = partial.begin();
+	auto t = byToken.begin();
+
+	while (k > 0 && (e != exact.end() || a != approximate.end() || p != partial.end() || t != byToken.end())) {
+
+		unsigned int id = UINT_MAX;
+		if (e != exact.end())
+			id = min(id, *e);
+		if (a != approximate.end())
+			id = min(id, a->first);
+		if (p != partial.end())
+			id = min(id, p->first);
+		if (t != byToken.end())
+			id = min(id, *t);
+
+		Candidate candidate(DBL_MAX, id);
+		SuggestionMatch match = TOKEN_MATCH;
+
+		if (t != byToken.end() && *t == id) {
+			candidate.first = 2 + maxDiff;
+			t++;
+		}
+		if (p != partial.end() && p->first == id) {
+			candidate.first = 1.5 + p->second;
+			match = PARTIAL_MATCH;
+			p++;
+		}
+		if (a != approximate.end() && a->first == id) {
+			if (1 + a->second < candidate.first) {
+				candidate.first = 1 + a->second;
+				match = APPROXIMATE_MATCH;
+			}
+			a++;
+		}
+		if (e != exact.end() && *e == id) {
+			double nameLength = searchKeys.at(id).length();
+			candidate.first = (nameLength - queryLength) / nameLength;
+			match = EXACT_MATCH;
+			e++;
+		}
+
+		if (best.size() < k || candidate < best.front().first) {
+			best.push_back(pair<Candidate, SuggestionMatch>(candidate, match));
+			push_heap(best.begin(), best.end(), worse);
+
+			if (best.size() > k) {
+				pop_heap(best.begin(), best.end(), worse);
+				best.pop_back();
+			}
+		}
+	}
+
+	sort_heap(best.begin(), best.end(), worse);
+
+	vector<StationSuggestion> res(best.size());
+	for (unsigned int i = 0; i < best.size(); i++) {
+		res[i].id = best[i].first.second;
+		res[i].name = stationNames.at(res[i].id);
+		res[i].score = best[i].first.first;
+		res[i].match = best[i].second;
+	}
+
+	return res;
+}
+
+/**
+ * @brief Normalizes a text like all the names in the index, see normalizeName()
+ *
+ * @param s The text
+ * @return The normalized text
+ */
+string StationIndex::normalize(const string & s) {
+	return normalizeName(s);
+}
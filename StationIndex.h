@@ -0,0 +1,150 @@
+/**
+ * @brief Index of the station names, to find the stations whose name contains a given text
+ *
+ * @file StationIndex.h
+ */
+#ifndef STATIONINDEX_H_
+#define STATIONINDEX_H_
+
+#include "Graph.h"
+#include "Autocomplete.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Edit distance allowed by StationIndex::suggestStations() for a whole name, per character of the query
+ */
+const double APPROXIMATE_TOLERANCE = 0.60;
+
+/**
+ * Edit distance allowed by StationIndex::suggestStations() between the words of a name and of the query
+ */
+const int TOKEN_MAX_DIFF = 1;
+
+/**
+ * Edit distance allowed by StationIndex::suggestStations() for a part of a name, per character of the query
+ */
+const double PARTIAL_TOLERANCE = 0.25;
+
+/**
+ * How a suggested station matched the text that was looked up
+ */
+enum SuggestionMatch {
+	EXACT_MATCH = 0,		///< the name contains the text
+	APPROXIMATE_MATCH = 1,	///< the name is within a certain edit distance of the text
+	PARTIAL_MATCH = 2,		///< some part of the name is within a certain edit distance of the text
+	TOKEN_MATCH = 3			///< a word of the name is within one edit of a word of the text
+};
+
+/**
+ * A station suggested for a text, see StationIndex::suggestStations()
+ */
+struct StationSuggestion {
+	unsigned int id;		///< the node ID of the station
+	string name;			///< the name of the station
+	double score;			///< how far the name is from the text, the lower the better
+	SuggestionMatch match;	///< the best way the station matched
+};
+
+/**
+ * @brief Metric tree (Burkhard-Keller) of words by their edit distance
+ *
+ * Each child of a node is labelled with its distance to the node, so a search for the words within
+ * distance k of a query only has to go into the children whose label is within k of the query's distance
+ * to the node (triangle inequality), instead of comparing the query to every word.
+ * Each word carries the IDs of the stations it belongs to.
+ *
+ * With a big distance the triangle inequality prunes almost nothing, so the words are also kept by length:
+ * then only the ones whose length is close enough to the query's are compared to it, and when only the closest
+ * words are wanted, the distance allowed shrinks as they are found.
+ */
+class BKTree {
+private:
+	struct BKNode {
+		string word;
+		vector<unsigned int> ids;
+		vector<pair<int, unsigned int> > children;	// distance to this node, index of the child
+		int maxChildDistance;
+	};
+
+	vector<BKNode> nodes;	// nodes[0] is the root
+	vector<vector<unsigned int> > byLength;	// the nodes of the words of each length
+
+	unsigned int addNode(const string & word, unsigned int id);
+
+public:
+	void insert(const string & word, unsigned int id);
+	void clear();
+	unsigned int size() const;
+
+	vector<pair<const vector<unsigned int> *, int> > find(string_view query, int maxDiff) const;
+	vector<pair<const vector<unsigned int> *, int> > findClosest(string_view query, int maxDiff, unsigned int k) const;
+};
+
+/**
+ * @brief Indexes of the names of all the stations, built once, after the graph's nodes have their final IDs
+ *
+ * For exact substrings, a generalized suffix array over the normalized names: every name is normalized and appended
+ * to a single text, each one ended by a separator. The suffixes of the text, sorted, put together all the places
+ * where a certain substring occurs, so the stations containing it are found with two binary searches.
+ *
+ * For approximate matches, BK-trees over the normalized names and over their words.
+ *
+ * For partial approximate matches, an inverted index of the trigrams (3 consecutive characters) of the names:
+ * for each trigram, the sorted list of the stations that have it. A text within k edits of some part of a name
+ * shares with it all its trigrams but at most 3k, so the candidates are the stations that are on enough of the lists
+ * of the text's trigrams, found merging them; only those are compared with the text.
+ *
+ * The names are normalized once, when the index is built: folded in case and accents, and without the common words
+ * (see normalizeName()). The queries are normalized the same way, so every search compares plain bytes.
+ */
+class StationIndex {
+private:
+	string text;					// the normalized names, each one followed by a separator
+	vector<unsigned int> suffixes;	// positions in text, sorted by the suffix starting there
+	vector<unsigned int> nameStarts;	// position in text where each name starts
+	vector<unsigned int> stationIDs;	// node ID of each name
+	vector<string> stationNames;	// the original names, by node ID
+	vector<string> searchKeys;		// the normalized names, by node ID
+
+	BKTree names;	// the normalized names
+	BKTree tokens;	// the words of the normalized names
+
+	vector<unsigned int> trigrams;			// the trigrams of the normalized names, sorted, each one once
+	vector<unsigned int> trigramStarts;		// where the stations of each trigram start in trigramStations (and one past the last)
+	vector<unsigned int> trigramStations;	// the node IDs of the stations with each trigram, sorted
+
+	Autocomplete completions;
+
+	unsigned int getNameIndex(unsigned int position) const;
+	int comparePrefix(unsigned int suffix, const string & pattern) const;
+
+	vector<unsigned int> findContainingKey(const string & key) const;
+	vector<pair<unsigned int, int> > findApproximateKey(const string & key, int maxDiff) const;
+	vector<pair<unsigned int, int> > findClosestKey(const string & key, int maxDiff, unsigned int k) const;
+	vector<unsigned int> findByTokenKey(const string & key, int maxDiff) const;
+	vector<pair<unsigned int, int> > findPartialKey(const string & key, int maxDiff) const;
+
+public:
+	StationIndex();
+	explicit StationIndex(const Graph<string> & g);
+
+	void build(const Graph<string> & g);
+	unsigned int getNumStations() const;
+	const string & getStationName(unsigned int id) const;
+	const string & getSearchKey(unsigned int id) const;
+	const Autocomplete & getAutocomplete() const;
+
+	vector<unsigned int> findContaining(const string & pattern) const;
+	vector<pair<unsigned int, int> > findApproximate(const string & pattern, int maxDiff) const;
+	vector<unsigned int> findByToken(const string & pattern, int maxDiff) const;
+	vector<pair<unsigned int, int> > findPartial(const string & pattern, int maxDiff) const;
+	vector<StationSuggestion> suggestStations(const string & query, unsigned int k) const;
+
+	static string normalize(const string & s);
+};
+
+#endif /* STATIONINDEX_H_ */
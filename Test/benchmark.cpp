@@ -0,0 +1,458 @@
+#include "benchmark.h"
+
+BenchmarkOptions getBenchmarkOptions(int argc, char *argv[]) {
+
+	BenchmarkOptions options;
+
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		size_t equals = option.find('=');
+		string name = option.substr(0, equals);
+		string value = equals == string::npos ? "" : option.substr(equals + 1);
+
+		if (name == "--network")
+			options.network = value;
+		else if (name == "--nodes")
+			options.nodesFile = value;
+		else if (name == "--edges")
+			options.edgesFile = value;
+		else if (name == "--grid-size")
+			options.gridSize = atoi(value.c_str());
+		else if (name == "--stops")
+			options.stops = atoi(value.c_str());
+		else if (name == "--queries")
+			options.queries = atoi(value.c_str());
+		else if (name == "--seed")
+			options.seed = atoi(value.c_str());
+		else if (name == "--modes") {
+			size_t start = 0;
+			while (start <= value.length()) {
+				size_t comma = value.find(',', start);
+				if (comma == string::npos)
+					comma = value.length();
+				if (comma > start)
+					options.modes.push_back(value.substr(start, comma - start));
+				start = comma + 1;
+			}
+		}
+		else if (name == "--max-transbords")
+			options.maxTransbords = atoi(value.c_str());
+		else if (name == "--walk-distance")
+			options.walkDistance = atof(value.c_str());
+		else if (name == "--format")
+			options.format = value;
+		else if (name == "--output")
+			options.output = value;
+		else if (name == "--trace")
+			options.trace = value;
+		else if (name == "--check-contraction")
+			options.checkContraction = value != "no";
+		else
+			cerr << "Unknown option " << option << " ignored\n";
+	}
+
+	return options;
+}
+
+void buildGridNetwork(Graph<string> &g, unsigned int size) {
+
+	const int spacing = 100;
+
+	for (unsigned int row = 0; row < size; row++)
+		for (unsigned int column = 0; column < size; column++)
+			g.addNode("Stop " + to_string(row) + "-" + to_string(column), column * spacing, row * spacing);
+
+	auto id = [size](unsigned int row, unsigned int column) {
+		return row * size + column;
+	};
+
+	for (unsigned int row = 0; row < size; row++) {
+		for (unsigned int column = 0; column < size; column++) {
+
+			// a bus line along each row
+			if (column + 1 < size) {
+				string line = "R" + to_string(row);
+				g.addBusEdge(id(row, column), id(row, column + 1), spacing, line);
+				g.addBusEdge(id(row, column + 1), id(row, column), spacing, line);
+			}
+
+			// a subway line along every fifth column, walking between the other vertical neighbours
+			if (row + 1 < size) {
+				if (column % 5 == 0) {
+					string line = "M" + to_string(column);
+					g.addSubwayEdge(id(row, column), id(row + 1, column), spacing, line);
+					g.addSubwayEdge(id(row + 1, column), id(row, column), spacing, line);
+				}
+				else {
+					g.addWalkEdge(id(row, column), id(row + 1, column), spacing, WALK);
+					g.addWalkEdge(id(row + 1, column), id(row, column), spacing, WALK);
+				}
+			}
+		}
+	}
+}
+
+void loadNetwork(Graph<string> &g, const BenchmarkOptions &options, bool contract) {
+
+	if (options.network == "grid")
+		buildGridNetwork(g, options.gridSize);
+	else if (options.network == "generated")
+		addNetwork(g, generateNetwork(getNetworkParameters(options.stops, options.seed)));
+	else {
+		loadNodes(g, options.nodesFile);
+		loadEdges(g, options.edgesFile);
+	}
+
+	g.findInterfaces();
+	g.collapseParallelEdges();
+	if (contract)
+		g.contractChains();
+	g.buildSpatialIndex();
+	g.buildLineIndex();
+}
+
+/**
+ * @brief A search mode from a generic lambda, called with the statistics policy to use
+ */
+template<typename Search>
+static SearchMode makeSearchMode(const string &name, ReferenceCheck check, PathCheck pathCheck, bool byPrice, Search search) {
+	return { name, [search](Graph<string> &g, Node<string> *s, Node<string> *t, CountingSearchStats *stats) {
+		return stats == NULL ? search(g, s, t, NoSearchStats()) : search(g, s, t, *stats);
+	}, check, pathCheck, byPrice };
+}
+
+vector<SearchMode> getSearchModes(const BenchmarkOptions &options) {
+
+	int maxTransbords = options.maxTransbords;
+	double walkDistance = options.walkDistance;
+
+	vector<SearchMode> modes = {
+		makeSearchMode("dijkstra_heap", LOWER_BOUND_TRIPS, SAME_PATHS, false, [](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.dijkstra_heap(s, t, stats);
+		}),
+		makeSearchMode("dijkstra_queue", SAME_TRIPS, SAME_PATHS, false, [](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.dijkstra_queue(s, t, stats);
+		}),
+		makeSearchMode("dijkstra_queue_NO_WALK", RESTRICTED_TRIPS, SAME_PATHS, false, [](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.dijkstra_queue_NO_WALK(s, t, stats);
+		}),
+		makeSearchMode("dijkstra_queue_TRANSBORDS", RESTRICTED_TRIPS, SAME_PATHS, false, [maxTransbords](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.dijkstra_queue_TRANSBORDS(s, t, maxTransbords, stats);
+		}),
+		makeSearchMode("dijkstra_queue_PRICE", RESTRICTED_TRIPS, ANY_PATHS, true, [walkDistance](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.dijkstra_queue_PRICE(s, t, walkDistance, stats);
+		}),
+		makeSearchMode("A_Star", SAME_TRIPS, SAME_STOPS, false, [](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+			return g.A_Star(s, t, stats);
+		})
+	};
+
+	if (options.modes.empty())
+		return modes;
+
+	vector<SearchMode> res;
+	for (const string &name : options.modes) {
+		auto it = find_if(modes.begin(), modes.end(), [&name](const SearchMode &mode) { return mode.name == name; });
+		if (it == modes.end())
+			cerr << "Unknown mode " << name << " ignored\n";
+		else
+			res.push_back(*it);
+	}
+
+	return res;
+}
+
+vector<pair<unsigned int, unsigned int>> getRandomQueries(const Graph<string> &g, unsigned int numQueries, unsigned int seed) {
+
+	vector<pair<unsigned int, unsigned int>> res;
+	if (g.getNumNodes() < 2)
+		return res;
+
+	mt19937 generator(seed);
+	uniform_int_distribution<unsigned int> node(0, g.getNumNodes() - 1);
+
+	while (res.size() < numQueries) {
+		unsigned int source = node(generator), dest = node(generator);
+		if (source != dest)
+			res.push_back(make_pair(source, dest));
+	}
+
+	return res;
+}
+
+Trip getTrip(const SearchMode &mode, Node<string> *last) {
+
+	Trip res;
+	if (last != NULL && last->getDistance() < DBL_MAX && (!mode.byPrice || last->getPrice() < DBL_MAX)) {
+		res.found = true;
+		res.distance = last->getDistance();
+	}
+
+	return res;
+}
+
+bool agreesWithReference(const SearchMode &mode, const Trip &trip, const Trip &reference) {
+
+	const double tolerance = 1e-9 * max(1.0, reference.distance);
+
+	if (mode.check == SAME_TRIPS)
+		return trip.found == reference.found && (!trip.found || fabs(trip.distance - reference.distance) <= tolerance);
+
+	if (mode.check == LOWER_BOUND_TRIPS)
+		return trip.found == reference.found && (!trip.found || trip.distance <= reference.distance + tolerance);
+
+	return !trip.found || (reference.found && trip.distance >= reference.distance - tolerance);
+}
+
+vector<Trip> getReferenceTrips(Graph<string> &g, const vector<pair<unsigned int, unsigned int>> &queries) {
+
+	SearchMode reference = makeSearchMode("dijkstra_queue", SAME_TRIPS, SAME_PATHS, false,
+			[](Graph<string> &g, Node<string> *s, Node<string> *t, auto &&stats) {
+		return g.dijkstra_queue(s, t, stats);
+	});
+
+	vector<Trip> res;
+	for (const pair<unsigned int, unsigned int> &query : queries)
+		res.push_back(getTrip(reference, reference.search(g, g.getNodeByID(query.first), g.getNodeByID(query.second), NULL)));
+
+	return res;
+}
+
+vector<pair<unsigned int, double>> getTripPath(Graph<string> &g, const SearchMode &mode, Node<string> *last) {
+
+	vector<pair<unsigned int, double>> res;
+	if (!getTrip(mode, last).found)
+		return res;
+
+	// the shortcuts are unpacked, and the skipped stops get their distances
+	for (Node<string> *node : g.getDetailedPath(last))
+		res.push_back(make_pair(node->getId(), node->getDistance()));
+
+	return res;
+}
+
+bool isPathOf(const Graph<string> &g, const vector<pair<unsigned int, double>> &path, unsigned int source, unsigned int dest) {
+
+	if (path.empty() || path.front().first != dest)
+		return false;
+
+	// each stop is reached from the next one, the last one from the departure
+	for (unsigned int i = 0; i < path.size(); i++) {
+		unsigned int previous = i + 1 < path.size() ? path[i + 1].first : source;
+		const vector<Edge<string>> &edges = g.getNodeByID(previous)->getEdges();
+		if (none_of(edges.begin(), edges.end(), [&](const Edge<string> &edge) { return edge.getDestiny()->getId() == path[i].first; }))
+			return false;
+	}
+
+	return true;
+}
+
+bool agreesWithoutShortcuts(const SearchMode &mode, const vector<pair<unsigned int, double>> &contracted,
+		const vector<pair<unsigned int, double>> &expected) {
+
+	auto sameDistance = [](double distance, double expected) {
+		return fabs(distance - expected) <= 1e-9 * max(1.0, expected);
+	};
+
+	if (contracted.empty() || expected.empty())
+		return contracted.empty() == expected.empty();
+
+	if (mode.pathCheck == ANY_PATHS)
+		return true;
+
+	if (contracted.size() != expected.size() || !sameDistance(contracted[0].second, expected[0].second))
+		return false;
+
+	for (unsigned int i = 0; i < expected.size(); i++)
+		if (contracted[i].first != expected[i].first
+				|| (mode.pathCheck == SAME_PATHS && !sameDistance(contracted[i].second, expected[i].second)))
+			return false;
+
+	return true;
+}
+
+vector<unsigned int> checkContraction(Graph<string> &g, const BenchmarkOptions &options, const vector<SearchMode> &modes,
+		const vector<pair<unsigned int, unsigned int>> &queries) {
+
+	Graph<string> plain;
+	loadNetwork(plain, options, false);
+
+	vector<unsigned int> res;
+
+	for (const SearchMode &mode : modes) {
+		unsigned int differences = 0;
+
+		for (const pair<unsigned int, unsigned int> &query : queries) {
+			vector<pair<unsigned int, double>> contracted = getTripPath(g, mode,
+					mode.search(g, g.getNodeByID(query.first), g.getNodeByID(query.second), NULL));
+			vector<pair<unsigned int, double>> expected = getTripPath(plain, mode,
+					mode.search(plain, plain.getNodeByID(query.first), plain.getNodeByID(query.second), NULL));
+
+			if (!agreesWithoutShortcuts(mode, contracted, expected)
+					|| (!contracted.empty() && !isPathOf(plain, contracted, query.first, query.second)))
+				differences++;
+		}
+
+		res.push_back(differences);
+	}
+
+	return res;
+}
+
+ModeResult runMode(Graph<string> &g, const SearchMode &mode, const vector<pair<unsigned int, unsigned int>> &queries,
+		const vector<Trip> &reference) {
+
+	ModeResult res;
+	res.mode = mode.name;
+	res.queries = queries.size();
+
+	for (unsigned int i = 0; i < queries.size(); i++) {
+		Node<string> *source = g.getNodeByID(queries[i].first), *dest = g.getNodeByID(queries[i].second);
+
+		auto start = chrono::steady_clock::now();
+
+		Node<string> *last = mode.search(g, source, dest, NULL);
+
+		auto finish = chrono::steady_clock::now();
+		double elapsed = chrono::duration<double, micro>(finish - start).count();
+
+		res.latencies.push_back(elapsed);
+		res.totalSeconds += elapsed / 1e6;
+
+		Trip trip = getTrip(mode, last);
+		if (trip.found)
+			res.found++;
+		if (!agreesWithReference(mode, trip, reference[i]))
+			res.mismatches++;
+
+		// the same search again, outside the measured time, counting its work
+		CountingSearchStats stats;
+		mode.search(g, source, dest, &stats);
+
+		const SearchCounters &counters = stats.getCounters();
+		res.total.resetNodes += counters.resetNodes;
+		res.total.settled += counters.settled;
+		res.total.relaxed += counters.relaxed;
+		res.total.inserts += counters.inserts;
+		res.total.decreaseKeys += counters.decreaseKeys;
+		res.maxSettled = max(res.maxSettled, counters.settled);
+		res.maxQueueSize = max(res.maxQueueSize, counters.maxQueueSize);
+	}
+
+	return res;
+}
+
+double getPercentile(const vector<double> &sorted, double fraction) {
+
+	if (sorted.empty())
+		return 0;
+
+	size_t rank = (size_t) ceil(fraction * sorted.size());
+	return sorted.at(rank == 0 ? 0 : rank - 1);
+}
+
+void writeResults(ostream &out, const BenchmarkOptions &options, const Graph<string> &g, const vector<ModeResult> &results) {
+
+	const bool json = options.format == "json";
+
+	if (json)
+		out << "[\n";
+	else
+		out << "network,nodes,edges,mode,queries,found,mismatches,p50_us,p95_us,p99_us,mean_us,throughput_qps,"
+				"mean_settled,max_settled,mean_relaxed,mean_inserts,mean_decrease_keys,max_queue_size,mean_reset_nodes\n";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const ModeResult &r = results[i];
+
+		vector<double> sorted = r.latencies;
+		sort(sorted.begin(), sorted.end());
+
+		double mean = r.queries == 0 ? 0 : r.totalSeconds * 1e6 / r.queries;
+		double throughput = r.totalSeconds == 0 ? 0 : r.queries / r.totalSeconds;
+		double queries = max(r.queries, 1u);
+		if (json) {
+			out << "  {\"network\": \"" << options.network << "\", \"nodes\": " << g.getNumNodes() << ", \"edges\": " << g.getNumEdges()
+					<< ", \"mode\": \"" << r.mode << "\", \"queries\": " << r.queries << ", \"found\": " << r.found << ", \"mismatches\": " << r.mismatches
+					<< ", \"p50_us\": " << getPercentile(sorted, 0.50) << ", \"p95_us\": " << getPercentile(sorted, 0.95)
+					<< ", \"p99_us\": " << getPercentile(sorted, 0.99) << ", \"mean_us\": " << mean
+					<< ", \"throughput_qps\": " << throughput << ", \"mean_settled\": " << r.total.settled / queries
+					<< ", \"max_settled\": " << r.maxSettled << ", \"mean_relaxed\": " << r.total.relaxed / queries
+					<< ", \"mean_inserts\": " << r.total.inserts / queries << ", \"mean_decrease_keys\": " << r.total.decreaseKeys / queries
+					<< ", \"max_queue_size\": " << r.maxQueueSize << ", \"mean_reset_nodes\": " << r.total.resetNodes / queries
+					<< "}" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		else {
+			out << options.network << "," << g.getNumNodes() << "," << g.getNumEdges() << "," << r.mode << "," << r.queries << ","
+					<< r.found << "," << r.mismatches << "," << getPercentile(sorted, 0.50) << "," << getPercentile(sorted, 0.95) << ","
+					<< getPercentile(sorted, 0.99) << "," << mean << "," << throughput << "," << r.total.settled / queries << ","
+					<< r.maxSettled << "," << r.total.relaxed / queries << "," << r.total.inserts / queries << ","
+					<< r.total.decreaseKeys / queries << "," << r.maxQueueSize << "," << r.total.resetNodes / queries << "\n";
+		}
+	}
+
+	if (json)
+		out << "]\n";
+}
+
+int main(int argc, char *argv[]) {
+
+	BenchmarkOptions options = getBenchmarkOptions(argc, argv);
+
+	if (!options.trace.empty())
+		startTracing();
+
+	Graph<string> g;
+	loadNetwork(g, options);
+
+	vector<pair<unsigned int, unsigned int>> queries = getRandomQueries(g, options.queries, options.seed);
+
+	vector<Trip> reference = getReferenceTrips(g, queries);
+	vector<SearchMode> modes = getSearchModes(options);
+
+	// a disagreement with dijkstra_queue, or with the network without shortcuts, is a bug, the run fails
+	bool disagree = false;
+
+	if (options.checkContraction) {
+		cerr << "Checking the shortcuts...\n";
+		vector<unsigned int> differences = checkContraction(g, options, modes, queries);
+
+		for (unsigned int i = 0; i < modes.size(); i++) {
+			if (differences[i] > 0) {
+				cerr << "Warning: " << modes[i].name << " gives different trips without the shortcuts on " << differences[i]
+						<< " of " << queries.size() << " queries\n";
+				disagree = true;
+			}
+		}
+	}
+
+	vector<ModeResult> results;
+	for (const SearchMode &mode : modes) {
+		cerr << "Running " << mode.name << "...\n";
+		results.push_back(runMode(g, mode, queries, reference));
+
+		if (results.back().mismatches > 0) {
+			cerr << "Warning: " << mode.name << " disagrees with dijkstra_queue on " << results.back().mismatches << " of "
+					<< queries.size() << " queries\n";
+			disagree = true;
+		}
+	}
+
+	if (!options.trace.empty()) {
+		stopTracing();
+		if (!writeTrace(options.trace))
+			cerr << "Unable to write " << options.trace << endl;
+	}
+
+	if (options.output.empty())
+		writeResults(cout, options, g, results);
+	else {
+		ofstream file(options.output);
+		if (!file.is_open()) {
+			cerr << "Unable to write " << options.output << endl;
+			return 1;
+		}
+		writeResults(file, options, g, results);
+	}
+
+	return disagree ? 2 : 0;
+}
@@ -0,0 +1,187 @@
+#include <vector>
+#include <string>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cfloat>
+#include <cmath>
+
+#include "../Graph.h"
+#include "../InfoLoader.h"
+#include "../NetworkGenerator.h"
+
+using namespace std;
+
+/**
+ * Options of a benchmark run, given in the command line
+ */
+struct BenchmarkOptions {
+	string network = "real";		///< "real" (the files), "grid" or "generated" (synthetic)
+	string nodesFile = "nos.txt";	///< the stations of the real network
+	string edgesFile = "arestas.txt";	///< the edges of the real network
+	unsigned int gridSize = 50;		///< stations in each side of the synthetic grid
+	unsigned int stops = 10000;		///< about how many stops the generated network has
+	unsigned int queries = 1000;	///< random origin-destination pairs searched by each mode
+	unsigned int seed = 1;			///< seed of the random pairs, the same pairs are searched by every mode
+	vector<string> modes;			///< the modes to run, all of them if empty
+	int maxTransbords = 3;			///< limit given to dijkstra_queue_TRANSBORDS
+	double walkDistance = 500;		///< limit given to dijkstra_queue_PRICE
+	string format = "csv";			///< "csv" or "json"
+	string output;					///< the file to write the results to, the standard output if empty
+	string trace;					///< if given, the Chrome trace of the run is written to this file
+	bool checkContraction = true;	///< also search a copy of the network without shortcuts, and compare the trips
+};
+
+/**
+ * How the trips found by a mode compare with the ones of dijkstra_queue, the reference
+ */
+enum ReferenceCheck {
+	SAME_TRIPS,			///< the same destinations are reached, in the same time
+	LOWER_BOUND_TRIPS,	///< the same destinations are reached, never slower (the transbord times are left out)
+	RESTRICTED_TRIPS	///< only trips that dijkstra_queue also finds, never faster than its trips
+};
+
+/**
+ * How the trips found by a mode on the network with shortcuts compare with the ones found without them
+ * In every case the same destinations are reached, along paths of the network without shortcuts.
+ */
+enum PathCheck {
+	SAME_PATHS,		///< through the same stops, each one reached in the same time
+	SAME_STOPS,		///< through the same stops, in the same time (the times of the stops on the way include the estimates of A*)
+	ANY_PATHS		///< each node keeps one ride and one walked time, so the trip found depends on the order of the search
+};
+
+/**
+ * A search algorithm of the Graph, run from a node to another, collecting its statistics if given a policy
+ */
+struct SearchMode {
+	string name;
+	function<Node<string> *(Graph<string> &, Node<string> *, Node<string> *, CountingSearchStats *)> search;
+	ReferenceCheck check;
+	PathCheck pathCheck;
+	bool byPrice;	///< it minimizes the price, a destination is reached when it has one
+};
+
+/**
+ * The trip a mode found for a query
+ */
+struct Trip {
+	bool found = false;
+	double distance = DBL_MAX;	///< the travel time
+};
+
+/**
+ * The measurements of a mode over all the queries
+ */
+struct ModeResult {
+	string mode;
+	unsigned int queries = 0;
+	unsigned int found = 0;			///< queries where the destination was reached
+	unsigned int mismatches = 0;	///< queries where the trip disagrees with dijkstra_queue, see ReferenceCheck
+	vector<double> latencies;		///< of each query, in microseconds
+	SearchCounters total;			///< the counters of all the queries added up
+	unsigned long long maxSettled = 0;	///< the most nodes settled by a query
+	unsigned long long maxQueueSize = 0;	///< the biggest queue of a query
+	double totalSeconds = 0;
+};
+
+/**
+ * @brief Reads the options given in the command line
+ * Accepted options are --network=real|grid|generated, --nodes=<file>, --edges=<file>, --grid-size=<n>, --stops=<n>,
+ * --queries=<n>, --seed=<n>, --modes=<mode,mode,...>, --max-transbords=<n>, --walk-distance=<d>,
+ * --format=csv|json, --output=<file>, --trace=<file> and --check-contraction=yes|no
+ */
+BenchmarkOptions getBenchmarkOptions(int argc, char *argv[]);
+
+/**
+ * @brief Builds a synthetic network: a square grid of stops, a bus line along each row (both ways),
+ * a subway line along every fifth column (both ways), and walk edges between the other vertical neighbours
+ *
+ * @param g The graph to add the network to
+ * @param size The number of stops in each side of the grid
+ */
+void buildGridNetwork(Graph<string> &g, unsigned int size);
+
+/**
+ * @brief Loads the network and prepares it as TripPlanner does before the searches
+ *
+ * @param contract If false, the chains of stops aren't contracted (see Graph::contractChains())
+ */
+void loadNetwork(Graph<string> &g, const BenchmarkOptions &options, bool contract = true);
+
+/**
+ * @brief All the search modes of the Graph, with the limits given in the options
+ */
+vector<SearchMode> getSearchModes(const BenchmarkOptions &options);
+
+/**
+ * @brief Random pairs of different nodes, the same for a given seed
+ */
+vector<pair<unsigned int, unsigned int>> getRandomQueries(const Graph<string> &g, unsigned int numQueries, unsigned int seed);
+
+/**
+ * @brief The trip found by a mode, after it searched
+ */
+Trip getTrip(const SearchMode &mode, Node<string> *last);
+
+/**
+ * @brief Tells if a trip of a mode agrees with the trip found by dijkstra_queue for the same query
+ */
+bool agreesWithReference(const SearchMode &mode, const Trip &trip, const Trip &reference);
+
+/**
+ * @brief The trips dijkstra_queue finds for every query, untimed
+ */
+vector<Trip> getReferenceTrips(Graph<string> &g, const vector<pair<unsigned int, unsigned int>> &queries);
+
+/**
+ * @brief The stations of the path a mode found, from the arrival to the departure (left out), each one with its distance
+ * Empty if no trip was found
+ */
+vector<pair<unsigned int, double>> getTripPath(Graph<string> &g, const SearchMode &mode, Node<string> *last);
+
+/**
+ * @brief Tells if a path, from the arrival to the departure, follows the edges of a graph between two nodes
+ * The departure isn't in the path, as getDetailedPath() leaves it out
+ */
+bool isPathOf(const Graph<string> &g, const vector<pair<unsigned int, double>> &path, unsigned int source, unsigned int dest);
+
+/**
+ * @brief Tells if the path a mode found on the network with shortcuts agrees with the one found without them
+ */
+bool agreesWithoutShortcuts(const SearchMode &mode, const vector<pair<unsigned int, double>> &contracted,
+		const vector<pair<unsigned int, double>> &expected);
+
+/**
+ * @brief Runs the queries with every mode on the network, with its shortcuts, and on a copy without them,
+ * comparing the unpacked paths as the PathCheck of the mode says
+ *
+ * @return The number of queries of each mode where the two differ
+ */
+vector<unsigned int> checkContraction(Graph<string> &g, const BenchmarkOptions &options, const vector<SearchMode> &modes,
+		const vector<pair<unsigned int, unsigned int>> &queries);
+
+/**
+ * @brief Runs every query with a mode, measuring each one
+ * Each query is timed without statistics, then run again, untimed, to count its work.
+ * Its trips are checked against the ones of dijkstra_queue.
+ */
+ModeResult runMode(Graph<string> &g, const SearchMode &mode, const vector<pair<unsigned int, unsigned int>> &queries,
+		const vector<Trip> &reference);
+
+/**
+ * @brief The value below which a fraction of the values are (nearest rank)
+ *
+ * @param sorted The values, sorted
+ * @param fraction Between 0 and 1, e.g. 0.95 for the 95th percentile
+ */
+double getPercentile(const vector<double> &sorted, double fraction);
+
+/**
+ * @brief Writes the results, one line (or object) per mode
+ */
+void writeResults(ostream &out, const BenchmarkOptions &options, const Graph<string> &g, const vector<ModeResult> &results);
@@ -0,0 +1,76 @@
+/**
+ * @brief Writes a synthetic transit network in the format of nos.txt and arestas.txt
+ * e.g. ./generate_network --stops=1000000 --nodes=big_nos.txt --edges=big_arestas.txt
+ *
+ * @file generate_network.cpp
+ */
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+#include "../NetworkGenerator.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+
+	NetworkParameters parameters;
+	string nodesFile = "generated_nos.txt";
+	string edgesFile = "generated_arestas.txt";
+
+	// --stops comes first, the other options change the parameters it gives
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (option.compare(0, 8, "--stops=") == 0)
+			parameters = getNetworkParameters(atoi(option.substr(8).c_str()));
+	}
+
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		size_t equals = option.find('=');
+		string name = option.substr(0, equals);
+		string value = equals == string::npos ? "" : option.substr(equals + 1);
+
+		if (name == "--stops")
+			continue;
+		else if (name == "--subway-lines")
+			parameters.numSubwayLines = atoi(value.c_str());
+		else if (name == "--bus-lines")
+			parameters.numBusLines = atoi(value.c_str());
+		else if (name == "--subway-stops")
+			parameters.stopsPerSubwayLine = atoi(value.c_str());
+		else if (name == "--bus-stops")
+			parameters.stopsPerBusLine = atoi(value.c_str());
+		else if (name == "--subway-spacing")
+			parameters.subwaySpacing = atof(value.c_str());
+		else if (name == "--bus-spacing")
+			parameters.busSpacing = atof(value.c_str());
+		else if (name == "--interchanges")
+			parameters.interchangeDensity = atof(value.c_str());
+		else if (name == "--walk-radius")
+			parameters.walkRadius = atof(value.c_str());
+		else if (name == "--area")
+			parameters.areaSize = atof(value.c_str());
+		else if (name == "--seed")
+			parameters.seed = atoi(value.c_str());
+		else if (name == "--nodes")
+			nodesFile = value;
+		else if (name == "--edges")
+			edgesFile = value;
+		else
+			cerr << "Unknown option " << option << " ignored\n";
+	}
+
+	auto start = chrono::steady_clock::now();
+	GeneratedNetwork network = generateNetwork(parameters);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cerr << network.stops.size() << " stops and " << network.links.size() << " edges generated in " << seconds << " s\n";
+
+	if (!writeNetwork(network, nodesFile, edgesFile)) {
+		cerr << "Unable to write " << nodesFile << " and " << edgesFile << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -2,6 +2,9 @@
 
 using namespace std;
 
+// the graph of these tests is only seen here, the Graph of TripPlanner has classes with the same names
+namespace {
+
 template<class T> class Edge;
 template<class T> class Graph;
 template<class T> class Node;
@@ -545,6 +548,8 @@ vector<T> Graph<T>::getPath(const T &origin, const T &dest) const {
 	return res;
 }
 
+}
+
 void geneateRandomGridGraph(int n, Graph<pair<int, int>> & g) {
 	std::random_device rd;
 	std::mt19937 gen(rd());
@@ -759,5 +764,8 @@ void compareAlgorithmsExtendedVersion() {
 
 
 int main() {
-	return 0;
-}
\ No newline at end of file
+	int failures = testTransbordBeforeComparison() + testImprovedAfterLeavingQueue() + testHeapOrder();
+
+	cout << failures << " wrong trips\n";
+	return failures == 0 ? 0 : 1;
+}
@@ -29,5 +29,13 @@ void compareAlgorithmsMatrixVersion();
 
 void testPath();
 
+// the searches of the Graph of TripPlanner, in test_dijkstra_graph.cpp; each one returns the number of wrong trips
+
+int testTransbordBeforeComparison();
+
+int testImprovedAfterLeavingQueue();
+
+int testHeapOrder();
+
 
 #endif
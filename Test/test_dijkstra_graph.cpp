@@ -0,0 +1,182 @@
+/**
+ * @brief Tests of the searches of the Graph used by TripPlanner (Graph.h)
+ * Each test builds a small network where a search used to find a wrong trip
+ *
+ * @file test_dijkstra_graph.cpp
+ */
+#include "test_dijkstra.h"
+#include "../Graph.h"
+
+using namespace std;
+
+/**
+ * @brief Tells if two travel times are the same, but for rounding
+ */
+static bool sameTime(double a, double b) {
+	return fabs(a - b) <= 1e-9 * max(1.0, fabs(b));
+}
+
+/**
+ * @brief Reports a search that found a different trip than expected
+ */
+static int check(const string &test, const string &search, double distance, double expected) {
+	if (sameTime(distance, expected))
+		return 0;
+
+	cout << test << ": " << search << " arrives in " << distance << ", expected " << expected << "\n";
+	return 1;
+}
+
+/**
+ * @brief Adds a bus edge both ways, its weight given as a travel time
+ */
+static void addBus(Graph<string> &g, unsigned int a, unsigned int b, double time, const string &line) {
+	g.addBusEdge(a, b, time / BUS_TIME_MULTIPLIER, line);
+	g.addBusEdge(b, a, time / BUS_TIME_MULTIPLIER, line);
+}
+
+/**
+ * @brief Adds a subway edge both ways, its weight given as a travel time
+ */
+static void addSubway(Graph<string> &g, unsigned int a, unsigned int b, double time, const string &line) {
+	g.addSubwayEdge(a, b, time / SUBWAY_TIME_MULTIPLIER, line);
+	g.addSubwayEdge(b, a, time / SUBWAY_TIME_MULTIPLIER, line);
+}
+
+/**
+ * @brief Searches a trip with each of the time-minimizing searches
+ *
+ * @return The arrival time at the destination, by search
+ */
+static vector<pair<string, double> > searchAll(Graph<string> &g, unsigned int source, unsigned int dest) {
+
+	Node<string> *s = g.getNodeByID(source), *t = g.getNodeByID(dest);
+	vector<pair<string, double> > res;
+
+	res.push_back(make_pair("A_Star", g.A_Star(s, t)->getDistance()));
+	res.push_back(make_pair("dijkstra_queue", g.dijkstra_queue(s, t)->getDistance()));
+	res.push_back(make_pair("dijkstra_queue_NO_WALK", g.dijkstra_queue_NO_WALK(s, t)->getDistance()));
+	res.push_back(make_pair("dijkstra_queue_TRANSBORDS", g.dijkstra_queue_TRANSBORDS(s, t, 3)->getDistance()));
+
+	return res;
+}
+
+/**
+ * @brief Builds the network of testTransbordBeforeComparison()
+ *
+ * @param subwayRoute If the route with a change from the bus to the subway is added
+ */
+static void buildTransbordNetwork(Graph<string> &g, bool subwayRoute) {
+
+	// all in the same place, so A_Star has no estimate to add
+	for (string name : { "S", "A", "B", "T" })
+		g.addNode(name, 0, 0);
+
+	// S -bus-> A -bus-> T, without changing vehicle
+	addBus(g, 0, 1, 1, "1");
+	addBus(g, 1, 3, 10, "1");
+
+	// S -bus-> B -subway-> T, two minutes faster by the edges, but three minutes slower with the change at B
+	if (subwayRoute) {
+		addBus(g, 0, 2, 1.5, "2");
+		addSubway(g, 2, 3, 7.5, "M");
+	}
+
+	g.findInterfaces();
+}
+
+int testTransbordBeforeComparison() {
+
+	Graph<string> direct;
+	buildTransbordNetwork(direct, false);
+	vector<pair<string, double> > expected = searchAll(direct, 0, 3);
+
+	/*
+	 * The subway route reaches T after the bus route, and used to replace it: the transbord time was
+	 * added after comparing the distances, so T got a longer one than it had
+	 */
+	Graph<string> g;
+	buildTransbordNetwork(g, true);
+	vector<pair<string, double> > found = searchAll(g, 0, 3);
+
+	int failures = 0;
+	for (unsigned int i = 0; i < found.size(); i++)
+		failures += check("testTransbordBeforeComparison", found[i].first, found[i].second, expected[i].second);
+
+	return failures;
+}
+
+int testImprovedAfterLeavingQueue() {
+
+	/*
+	 * The estimate of A_Star is the straight line at the speed of the subway, and the edge P-X is much faster
+	 * than that: X leaves the queue reached from S, and is then reached sooner through P.
+	 * decreaseKey() used to be called on X, out of the queue, and dereferenced the empty slot 0 of the heap
+	 */
+	Graph<string> g;
+	g.addNode("S", 0, 0);
+	g.addNode("P", -1000, 0);
+	g.addNode("X", 900, 0);
+	g.addNode("T", 1000, 0);
+
+	addBus(g, 0, 2, 30, "1");
+	addBus(g, 0, 1, 1, "2");
+	addBus(g, 1, 2, 1, "2");
+	addBus(g, 2, 3, 50, "1");
+	g.findInterfaces();
+
+	double expected = 1 + 1 + 50;
+	int failures = 0;
+
+	Node<string> *t = g.A_Star(g.getNodeByID(0), g.getNodeByID(3));
+	failures += check("testImprovedAfterLeavingQueue", "A_Star", t->getDistance(), expected);
+
+	vector<Node<string> *> path = g.getDetailedPath(t);
+	if (path.size() != 3 || path[1]->getId() != 2 || path[2]->getId() != 1) {
+		cout << "testImprovedAfterLeavingQueue: A_Star doesn't go through P\n";
+		failures++;
+	}
+
+	t = g.dijkstra_queue(g.getNodeByID(0), g.getNodeByID(3));
+	failures += check("testImprovedAfterLeavingQueue", "dijkstra_queue", t->getDistance(), expected);
+
+	return failures;
+}
+
+int testHeapOrder() {
+
+	/*
+	 * Only buses, so no transbord time that dijkstra_heap leaves out: it finds the same trips as dijkstra_queue.
+	 * The heap used to be popped comparing the node pointers instead of the distances
+	 */
+	const int size = 8;
+	Graph<string> g;
+	mt19937 generator(1);
+	uniform_real_distribution<double> time(1, 10);
+
+	for (int i = 0; i < size * size; i++)
+		g.addNode(to_string(i), i % size, i / size);
+
+	for (int i = 0; i < size * size; i++) {
+		if (i % size + 1 < size)
+			addBus(g, i, i + 1, time(generator), "row" + to_string(i / size));
+		if (i + size < size * size)
+			addBus(g, i, i + size, time(generator), "column" + to_string(i % size));
+	}
+	g.findInterfaces();
+
+	int failures = 0;
+
+	for (int source = 0; source < size * size; source++) {
+		for (int dest = 0; dest < size * size; dest++) {
+			if (source == dest)
+				continue;
+
+			double expected = g.dijkstra_queue(g.getNodeByID(source), g.getNodeByID(dest))->getDistance();
+			double distance = g.dijkstra_heap(g.getNodeByID(source), g.getNodeByID(dest))->getDistance();
+			failures += check("testHeapOrder", "dijkstra_heap", distance, expected);
+		}
+	}
+
+	return failures;
+}
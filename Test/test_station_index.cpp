@@ -0,0 +1,352 @@
+#include "test_station_index.h"
+#include <climits>
+
+int main() {
+
+	int differences = 0;
+
+	// the stations of TripPlanner
+	Graph<string> real;
+	loadNodes(real);
+	loadEdges(real);
+	differences += testStationIndex(real, "nos.txt");
+
+	// more, and longer, names
+	Graph<string> generated;
+	addNetwork(generated, generateNetwork(getNetworkParameters(1000)));
+	differences += testStationIndex(generated, "generated");
+
+	return differences == 0 ? 0 : 1;
+}
+
+int substringEditDistanceDP(const string &text, const string &pattern) {
+
+	// cur[i]: the distance of the first i characters of the pattern to the best substring ending at the current column
+	vector<int> cur(pattern.length() + 1);
+	for (unsigned int i = 0; i <= pattern.length(); i++)
+		cur[i] = i;
+
+	int best = cur[pattern.length()];
+
+	for (unsigned int j = 1; j <= text.length(); j++) {
+		int pre = cur[0];
+		cur[0] = 0;	// a substring can start anywhere
+		for (unsigned int i = 1; i <= pattern.length(); i++) {
+			int temp = cur[i];
+			if (pattern[i - 1] == text[j - 1])
+				cur[i] = pre;
+			else
+				cur[i] = min(pre + 1, min(cur[i] + 1, cur[i - 1] + 1));
+			pre = temp;
+		}
+		best = min(best, cur[pattern.length()]);
+	}
+
+	return best;
+}
+
+vector<string> getQueries(const StationIndex &index, mt19937 &generator) {
+
+	const unsigned int maxNames = 100;
+	const string letters = "abcdefghijklmnopqrstuvwxyz ";
+
+	vector<string> res = { "", "porto", "sao", "trindad", "casa musica", "camapanha", "xyz", "da", "a" };
+
+	vector<unsigned int> ids(index.getNumStations());
+	for (unsigned int i = 0; i < ids.size(); i++)
+		ids[i] = i;
+	shuffle(ids.begin(), ids.end(), generator);
+	if (ids.size() > maxNames)
+		ids.resize(maxNames);
+
+	for (unsigned int id : ids) {
+		string name = index.getStationName(id);
+
+		res.push_back(name);
+		res.push_back(name.substr(0, name.find(' ')));
+		res.push_back(name.substr(0, name.length() / 2));
+		res.push_back(name.substr(name.length() / 3));
+
+		if (name.empty())
+			continue;
+
+		// a character missing, a wrong one and one too many
+		string typo = name;
+		typo.erase(generator() % typo.length(), 1);
+		res.push_back(typo);
+
+		typo = name;
+		typo[generator() % typo.length()] = letters[generator() % letters.length()];
+		res.push_back(typo);
+
+		typo = name;
+		typo.insert(typo.begin() + generator() % (typo.length() + 1), letters[generator() % letters.length()]);
+		res.push_back(typo);
+	}
+
+	return res;
+}
+
+/**
+ * @brief Reports a query where the index and the scan differ
+ */
+static void reportDifference(const string &what, const string &query, int maxDiff) {
+	cout << what << "(\"" << query << "\", " << maxDiff << ") differs from the scan\n";
+}
+
+int compareFinders(const StationIndex &index, const vector<string> &queries) {
+
+	int differences = 0;
+
+	for (const string &query : queries) {
+		string key = StationIndex::normalize(query);
+
+		vector<unsigned int> containing;
+		for (unsigned int id = 0; id < index.getNumStations(); id++)
+			if (!key.empty() && index.getSearchKey(id).find(key) != string::npos)
+				containing.push_back(id);
+
+		if (index.findContaining(query) != containing) {
+			reportDifference("findContaining", query, 0);
+			differences++;
+		}
+
+		// the distances of each station to the query, each one filtered by every maxDiff below
+		vector<int> nameDistances;
+		vector<int> tokenDistances;
+		vector<int> partialDistances;
+
+		for (unsigned int id = 0; id < index.getNumStations(); id++) {
+			const string &name = index.getSearchKey(id);
+
+			nameDistances.push_back(editDistanceDP(name, key));
+
+			int tokenDistance = INT_MAX;
+			for (string_view word : Tokens(key))
+				for (string_view nameWord : Tokens(name))
+					tokenDistance = min(tokenDistance, editDistanceDP(string(nameWord), string(word)));
+			tokenDistances.push_back(tokenDistance);
+
+			partialDistances.push_back(key.empty() ? INT_MAX : substringEditDistanceDP(name, key));
+		}
+
+		for (int maxDiff = 0; maxDiff <= 4; maxDiff++) {
+			vector<pair<unsigned int, int> > approximate;
+			vector<unsigned int> byToken;
+			vector<pair<unsigned int, int> > partial;
+
+			for (unsigned int id = 0; id < index.getNumStations(); id++) {
+				if (nameDistances[id] <= maxDiff)
+					approximate.push_back(make_pair(id, nameDistances[id]));
+				if (tokenDistances[id] <= maxDiff)
+					byToken.push_back(id);
+				if (partialDistances[id] <= maxDiff)
+					partial.push_back(make_pair(id, partialDistances[id]));
+			}
+
+			if (index.findApproximate(query, maxDiff) != approximate) {
+				reportDifference("findApproximate", query, maxDiff);
+				differences++;
+			}
+			if (index.findByToken(query, maxDiff) != byToken) {
+				reportDifference("findByToken", query, maxDiff);
+				differences++;
+			}
+			if (index.findPartial(query, maxDiff) != partial) {
+				reportDifference("findPartial", query, maxDiff);
+				differences++;
+			}
+		}
+	}
+
+	return differences;
+}
+
+int compareSuggestions(const StationIndex &index, const vector<string> &queries) {
+
+	int differences = 0;
+
+	for (const string &query : queries) {
+		string key = StationIndex::normalize(query);
+		double queryLength = key.length();
+
+		vector<string> keyTrigrams;
+		for (unsigned int i = 0; i + 3 <= key.length(); i++)
+			keyTrigrams.push_back(key.substr(i, 3));
+		sort(keyTrigrams.begin(), keyTrigrams.end());
+		keyTrigrams.erase(unique(keyTrigrams.begin(), keyTrigrams.end()), keyTrigrams.end());
+
+		int maxDiff = queryLength * APPROXIMATE_TOLERANCE;
+		int partialDiff = queryLength * PARTIAL_TOLERANCE;
+		partialDiff = max(0, min(partialDiff, ((int) keyTrigrams.size() - 1) / 3));
+
+		// every station, scored by its best match
+		vector<StationSuggestion> ranking;
+
+		for (unsigned int id = 0; id < index.getNumStations(); id++) {
+			const string &name = index.getSearchKey(id);
+			StationSuggestion suggestion = { id, index.getStationName(id), DBL_MAX, TOKEN_MATCH };
+
+			for (string_view word : Tokens(key))
+				for (string_view nameWord : Tokens(name))
+					if (editDistanceDP(string(nameWord), string(word)) <= TOKEN_MAX_DIFF)
+						suggestion.score = 2 + maxDiff;
+
+			int distance = key.empty() ? INT_MAX : substringEditDistanceDP(name, key);
+			if (distance <= partialDiff) {
+				suggestion.score = 1.5 + distance;
+				suggestion.match = PARTIAL_MATCH;
+			}
+
+			distance = editDistanceDP(name, key);
+			if (distance <= maxDiff && 1 + distance < suggestion.score) {
+				suggestion.score = 1 + distance;
+				suggestion.match = APPROXIMATE_MATCH;
+			}
+
+			if (!key.empty() && name.find(key) != string::npos) {
+				suggestion.score = (name.length() - queryLength) / name.length();
+				suggestion.match = EXACT_MATCH;
+			}
+
+			if (suggestion.score < DBL_MAX)
+				ranking.push_back(suggestion);
+		}
+
+		sort(ranking.begin(), ranking.end(), [](const StationSuggestion &a, const StationSuggestion &b) {
+			return a.score != b.score ? a.score < b.score : a.id < b.id;
+		});
+
+		for (unsigned int k : { 1, 5, 20 }) {
+			vector<StationSuggestion> suggestions = index.suggestStations(query, k);
+
+			bool same = suggestions.size() == min((size_t) k, ranking.size());
+			for (unsigned int i = 0; same && i < suggestions.size(); i++)
+				same = suggestions[i].id == ranking[i].id && suggestions[i].score == ranking[i].score
+						&& suggestions[i].match == ranking[i].match && suggestions[i].name == ranking[i].name;
+
+			if (!same) {
+				reportDifference("suggestStations", query, k);
+				differences++;
+			}
+		}
+	}
+
+	return differences;
+}
+
+/**
+ * @brief The length of the UTF-8 character starting with a byte
+ */
+static size_t getCharacterLength(unsigned char lead) {
+	return lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+}
+
+int compareCompletions(const Graph<string> &g, const StationIndex &index) {
+
+	const Autocomplete &autocomplete = index.getAutocomplete();
+	int differences = 0;
+
+	vector<unsigned int> popularity(g.getNumNodes(), 0);
+	for (const auto &line : g.getStationsByLine())
+		for (unsigned int id : line.second)
+			popularity.at(id)++;
+
+	// the parts of each folded name that can be completed: the whole name, and from each word but the common ones
+	vector<string> names(g.getNumNodes());
+	vector<pair<string, unsigned int> > parts;
+
+	for (unsigned int id = 0; id < g.getNumNodes(); id++) {
+		names[id] = foldText(index.getStationName(id));
+
+		size_t start = 0;
+		while (start < names[id].length()) {
+			size_t wordEnd = min(names[id].find(' ', start), names[id].length());
+			if (start == 0 || !isCommonWord(string_view(names[id]).substr(start, wordEnd - start)))
+				parts.push_back(make_pair(names[id].substr(start), id));
+			start = wordEnd + 1;
+		}
+	}
+
+	auto complete = [&](const string &prefix) {
+		string folded = foldText(prefix);
+
+		vector<unsigned int> res;
+		for (const pair<string, unsigned int> &part : parts)
+			if (part.first.compare(0, folded.length(), folded) == 0)
+				res.push_back(part.second);
+
+		sort(res.begin(), res.end(), [&](unsigned int a, unsigned int b) {
+			if (popularity[a] != popularity[b])
+				return popularity[a] > popularity[b];
+			if (names[a] != names[b])
+				return names[a] < names[b];
+			return a < b;
+		});
+		res.erase(unique(res.begin(), res.end()), res.end());
+		if (res.size() > MAX_COMPLETIONS)
+			res.resize(MAX_COMPLETIONS);
+
+		return res;
+	};
+
+	for (unsigned int id = 0; id < g.getNumNodes() && id < 300; id++) {
+		const string &name = index.getStationName(id);
+
+		// typed a character at a time, then some characters no name has, then all erased
+		Autocomplete::Cursor cursor = autocomplete.getCursor();
+		vector<vector<unsigned int> > typed(1, cursor.getCompletions());
+		vector<string> prefixes(1, "");
+
+		string text = name + "#~";
+		for (size_t i = 0; i < text.length();) {
+			size_t length = min(getCharacterLength(text[i]), text.length() - i);
+			cursor.type(text.substr(i, length));
+			i += length;
+
+			typed.push_back(cursor.getCompletions());
+			prefixes.push_back(text.substr(0, i));
+		}
+
+		for (unsigned int i = 0; i < prefixes.size(); i++) {
+			vector<unsigned int> expected = complete(prefixes[i]);
+			if (autocomplete.complete(prefixes[i]) != expected || typed[i] != expected) {
+				cout << "complete(\"" << prefixes[i] << "\") differs from the scan\n";
+				differences++;
+			}
+		}
+
+		for (unsigned int i = prefixes.size() - 1; i > 0; i--) {
+			cursor.erase();
+			if (cursor.getCompletions() != typed[i - 1]) {
+				cout << "Erasing back to \"" << prefixes[i - 1] << "\" gives different completions\n";
+				differences++;
+			}
+		}
+	}
+
+	return differences;
+}
+
+int testStationIndex(Graph<string> &g, const string &network) {
+
+	g.findInterfaces();
+	g.buildLineIndex();
+
+	StationIndex index(g);
+	mt19937 generator(1);
+	vector<string> queries = getQueries(index, generator);
+
+	cout << "*** Testing the station index of " << network << " (" << index.getNumStations() << " stations, "
+			<< queries.size() << " queries) ***\n\n";
+
+	int finders = compareFinders(index, queries);
+	int suggestions = compareSuggestions(index, queries);
+	int completions = compareCompletions(g, index);
+
+	cout << "Finders: " << finders << " differences\n";
+	cout << "Suggestions: " << suggestions << " differences\n";
+	cout << "Completions: " << completions << " differences\n\n";
+
+	return finders + suggestions + completions;
+}
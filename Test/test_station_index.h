@@ -0,0 +1,58 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <iostream>
+#include <cfloat>
+
+#include "../Graph.h"
+#include "../InfoLoader.h"
+#include "../StationIndex.h"
+#include "../stringSearch.h"
+#include "../NetworkGenerator.h"
+
+using namespace std;
+
+/**
+ * @brief The smallest edit distance between a pattern and any substring of a text, a cell at a time (Sellers)
+ * Reference for the bit-parallel substringEditDistance()
+ */
+int substringEditDistanceDP(const string &text, const string &pattern);
+
+/**
+ * @brief Texts to look up in the index: the names, parts of them, the names with typos, and some random texts
+ *
+ * @param index The index
+ * @param generator Where the typos come from
+ */
+vector<string> getQueries(const StationIndex &index, mt19937 &generator);
+
+/**
+ * @brief Compares findContaining(), findApproximate(), findByToken() and findPartial() with a scan of every station
+ *
+ * @return The number of queries where they differ
+ */
+int compareFinders(const StationIndex &index, const vector<string> &queries);
+
+/**
+ * @brief Compares suggestStations() with the ranking of every station, scored as it documents
+ *
+ * @return The number of queries where they differ
+ */
+int compareSuggestions(const StationIndex &index, const vector<string> &queries);
+
+/**
+ * @brief Compares Autocomplete::complete() with a scan of every station, and checks that a Cursor
+ * gives the same completions as it types and erases a text
+ *
+ * @return The number of prefixes where they differ
+ */
+int compareCompletions(const Graph<string> &g, const StationIndex &index);
+
+/**
+ * @brief Runs all the comparisons over the stations of a graph
+ *
+ * @param network What the graph is, for the report
+ * @return The number of differences found
+ */
+int testStationIndex(Graph<string> &g, const string &network);
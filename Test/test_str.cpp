@@ -6,6 +6,10 @@ int main() {
 	//compareAlgorithmsIncrementText();
 	//compareAlgorithmsIncrementBoth();
 	compareAlgorithmsKMP();
+	int mismatches = compareEditDistanceAlgorithms();
+	compareSubstringMatchers();
+
+	return mismatches == 0 ? 0 : 1;
 }
 
 std::string random_string( size_t length )
@@ -162,8 +166,7 @@ void compareAlgorithmsKMP() {
 	vector<double> kmpTimes; // the normal kmp
 	vector<double> kmpPrefTimes; // the kmp without computing prefix
 
-	int *pi = (int *)malloc(sizeof(int)*5000);
-	computerPrefixFunction(pattern, pi);
+	CompiledPattern compiled(pattern);
 
 	cout << "*** Testing Kmp and Edit Distance *** \n\n";
 
@@ -182,7 +185,7 @@ void compareAlgorithmsKMP() {
 
 		start = std::chrono::high_resolution_clock::now();
 
-		kmpMatcher(pattern, text, pi);
+		compiled.count(text);
 
 		finish = std::chrono::high_resolution_clock::now();
 		elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
@@ -196,6 +199,174 @@ void compareAlgorithmsKMP() {
 	}
 
 	cout << endl;
+}
 
-	free(pi);
-}
\ No newline at end of file
+/**
+ * @brief Checks every version of the bit-parallel edit distance of a text and a pattern against the dynamic programming one
+ *
+ * @return true if all of them agree
+ */
+static bool checkEditDistance(const string &text, const string &pattern) {
+
+	int expected = editDistanceDP(text, pattern);
+	CompiledPattern compiled(pattern);
+
+	bool agree = editDistance(text, pattern) == expected;
+
+	// the bounded versions give the distance, or maxDiff + 1 when it is bigger
+	for (int maxDiff : {0, 1, 2, 3, expected - 1, expected, expected + 1}) {
+		if (maxDiff < 0)
+			continue;
+		int bounded = min(expected, maxDiff + 1);
+		agree = agree && editDistance(text, pattern, maxDiff) == bounded;
+		agree = agree && compiled.editDistance(text, maxDiff) == bounded;
+	}
+
+	if (!agree)
+		cout << "Different edit distances of \"" << text << "\" and \"" << pattern << "\" (expected " << expected << ")\n";
+
+	return agree;
+}
+
+int compareEditDistanceAlgorithms() {
+
+	vector<double> dpTimes; // the classic dynamic programming
+	vector<double> bitTimes; // the bit-parallel version
+	int mismatches = 0;
+
+	cout << "*** Testing Edit Distance (dynamic programming and bit-parallel) *** \n\n";
+
+	for(unsigned int i = 16; i <= 256; i *= 2){
+
+		string pattern = random_string(i);
+		vector<string> texts;
+		for(unsigned int j = 0; j < 1000; j++)
+			texts.push_back(random_string(i));
+
+		vector<int> dpResults;
+		vector<int> bitResults;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for(const string &text : texts)
+			dpResults.push_back(editDistanceDP(text, pattern));
+
+		auto finish = std::chrono::high_resolution_clock::now();
+		auto elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
+
+		dpTimes.push_back(elapsed);
+
+		start = std::chrono::high_resolution_clock::now();
+
+		for(const string &text : texts)
+			bitResults.push_back(editDistance(text, pattern));
+
+		finish = std::chrono::high_resolution_clock::now();
+		elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
+
+		bitTimes.push_back(elapsed);
+
+		for(unsigned int j = 0; j < texts.size(); j++)
+			if(dpResults.at(j) != bitResults.at(j) && !checkEditDistance(texts.at(j), pattern))
+				mismatches++;
+	}
+
+	for(unsigned int i = 0; i < dpTimes.size(); i++){
+		cout << "Pattern size: " << (16 << i) << "  DP time: " << dpTimes.at(i) << "  Bit-parallel time: " << bitTimes.at(i) << endl;
+	}
+
+	// close texts over a small alphabet, across the 64 characters of a word, and texts with the pattern as prefix or suffix
+	mt19937 generator(1);
+	auto randomText = [&generator](unsigned int length) {
+		string res;
+		for(unsigned int i = 0; i < length; i++)
+			res += "ab "[generator() % 3];
+		return res;
+	};
+
+	for(unsigned int i = 0; i < 20000; i++){
+		string pattern = randomText(generator() % 150);
+		string text = randomText(generator() % 150);
+
+		mismatches += !checkEditDistance(text, pattern);
+		mismatches += !checkEditDistance(pattern + text, pattern);
+		mismatches += !checkEditDistance(text + pattern, pattern);
+		mismatches += !checkEditDistance(pattern, pattern + text);
+	}
+
+	for(const auto &names : vector<pair<string, string>>{ {"porto campanha", "porto"}, {"sao bento", "sao"}, {"trindade", "trindade"} })
+		mismatches += !checkEditDistance(names.first, names.second);
+
+	cout << (mismatches == 0 ? "All edit distances agree" : to_string(mismatches) + " different edit distances!") << endl;
+
+	cout << endl;
+
+	return mismatches;
+}
+
+int naiveMatcher(const string &text, const string &pattern) {
+	int result = 0;
+
+	for(unsigned int i = 0; i + pattern.length() <= text.length(); i++){
+		unsigned int j = 0;
+		while(j < pattern.length() && text[i + j] == pattern[j])
+			j++;
+		if(j == pattern.length())
+			result++;
+	}
+
+	return result;
+}
+
+void compareSubstringMatchers() {
+
+	vector<double> naiveTimes;
+	vector<double> kmpTimes;
+	vector<double> simdTimes;
+	vector<bool> agree; // the three found the same number of occurrences
+
+	cout << "*** Testing Substring Matching (naive, KMP and SIMD) *** \n\n";
+
+	string text = random_string(1000000);
+
+	for(unsigned int i = 2; i <= 64; i *= 2){
+
+		// a pattern taken from the text, so it occurs at least once
+		string pattern = text.substr(rand() % (text.length() - i), i);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		int naive = naiveMatcher(text, pattern);
+
+		auto finish = std::chrono::high_resolution_clock::now();
+		auto elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
+
+		naiveTimes.push_back(elapsed);
+
+		start = std::chrono::high_resolution_clock::now();
+
+		int kmp = kmpMatcher(text, pattern);
+
+		finish = std::chrono::high_resolution_clock::now();
+		elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
+
+		kmpTimes.push_back(elapsed);
+
+		start = std::chrono::high_resolution_clock::now();
+
+		int simd = simdMatcher(text, pattern);
+
+		finish = std::chrono::high_resolution_clock::now();
+		elapsed = chrono::duration_cast<chrono::microseconds>(finish - start).count();
+
+		simdTimes.push_back(elapsed);
+		agree.push_back(naive == kmp && kmp == simd);
+	}
+
+	for(unsigned int i = 0; i < naiveTimes.size(); i++){
+		cout << "Pattern size: " << (2 << i) << "  Naive time: " << naiveTimes.at(i) << "  KMP time: " << kmpTimes.at(i)
+			<< "  SIMD time: " << simdTimes.at(i) << (agree.at(i) ? "" : "  (different results!)") << endl;
+	}
+
+	cout << endl;
+}
@@ -30,4 +30,17 @@ std::string random_string(size_t length);
 void compareAlgorithmsIncrementPattern();
 void compareAlgorithmsIncrementText();
 void compareAlgorithmsIncrementBoth();
-void compareAlgorithmsKMP() ;
\ No newline at end of file
+void compareAlgorithmsKMP() ;
+
+/**
+ * @brief Times the dynamic programming and bit-parallel edit distances, and checks that all the versions agree
+ *
+ * @return The number of texts where they differ
+ */
+int compareEditDistanceAlgorithms();
+void compareSubstringMatchers();
+
+/**
+ * @brief Counts the occurrences of pattern in text comparing it at every position, as a baseline
+ */
+int naiveMatcher(const string &text, const string &pattern);
\ No newline at end of file
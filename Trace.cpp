@@ -0,0 +1,113 @@
+/**
+ * @brief Tracing of where the time goes (loading, preprocessing, lookups, searches, viewer), written in the Chrome trace format
+ *
+ * @file Trace.cpp
+ */
+#include "Trace.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+
+atomic<bool> tracingEnabled(false);
+
+/**
+ * @brief A finished scope
+ */
+struct TraceEvent {
+	const char *name;
+	const char *category;
+	double start;
+	double duration;
+};
+
+/**
+ * @brief The events of a thread, in a ring buffer only that thread writes to
+ */
+struct ThreadTrace {
+	unsigned int tid;
+	vector<TraceEvent> events;
+	atomic<unsigned long long> numRecorded;	// events recorded so far, the last TRACE_BUFFER_SIZE of them are kept
+
+	explicit ThreadTrace(unsigned int tid) : tid(tid), events(TRACE_BUFFER_SIZE), numRecorded(0) {}
+};
+
+static const chrono::steady_clock::time_point traceEpoch = chrono::steady_clock::now();
+
+// the buffers of all the threads that recorded something, kept after the threads end
+static mutex threadTracesMutex;
+static vector<shared_ptr<ThreadTrace> > threadTraces;
+
+/**
+ * @brief The buffer of the calling thread, registered the first time it records something
+ */
+static ThreadTrace &getThreadTrace() {
+	thread_local shared_ptr<ThreadTrace> trace;
+
+	if (!trace) {
+		lock_guard<mutex> lock(threadTracesMutex);
+		trace = make_shared<ThreadTrace>(threadTraces.size() + 1);
+		threadTraces.push_back(trace);
+	}
+
+	return *trace;
+}
+
+void startTracing() {
+	tracingEnabled = true;
+}
+
+void stopTracing() {
+	tracingEnabled = false;
+}
+
+double getTraceTime() {
+	return chrono::duration<double, micro>(chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void recordTraceEvent(const char *name, const char *category, double start, double duration) {
+	ThreadTrace &trace = getThreadTrace();
+
+	unsigned long long n = trace.numRecorded.load(memory_order_relaxed);
+	trace.events[n % TRACE_BUFFER_SIZE] = {name, category, start, duration};
+	trace.numRecorded.store(n + 1, memory_order_release);
+}
+
+static string escapeJSON(const char *s) {
+	string res;
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\')
+			res += '\\';
+		res += *s;
+	}
+	return res;
+}
+
+bool writeTrace(const string &filename) {
+	ofstream file(filename);
+	if (!file.is_open())
+		return false;
+
+	lock_guard<mutex> lock(threadTracesMutex);
+
+	file << "{\"traceEvents\": [\n";
+
+	bool first = true;
+	for (const shared_ptr<ThreadTrace> &trace : threadTraces) {
+		unsigned long long n = trace->numRecorded.load(memory_order_acquire);
+		unsigned long long begin = n > TRACE_BUFFER_SIZE ? n - TRACE_BUFFER_SIZE : 0;
+
+		for (unsigned long long i = begin; i < n; i++) {
+			const TraceEvent &event = trace->events[i % TRACE_BUFFER_SIZE];
+
+			file << (first ? "" : ",\n") << "{\"name\": \"" << escapeJSON(event.name) << "\", \"cat\": \""
+					<< escapeJSON(event.category) << "\", \"ph\": \"X\", \"ts\": " << fixed << event.start
+					<< ", \"dur\": " << event.duration << ", \"pid\": 1, \"tid\": " << trace->tid << "}";
+			first = false;
+		}
+	}
+
+	file << "\n], \"displayTimeUnit\": \"ms\"}\n";
+
+	return file.good();
+}
@@ -0,0 +1,96 @@
+/**
+ * @brief Tracing of where the time goes (loading, preprocessing, lookups, searches, viewer), written in the Chrome trace format
+ *
+ * @file Trace.h
+ */
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <string>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * Events kept by each thread; when more are recorded, the oldest ones are overwritten
+ */
+const unsigned int TRACE_BUFFER_SIZE = 1 << 16;
+
+extern atomic<bool> tracingEnabled;
+
+/**
+ * @brief Starts recording the traced scopes (nothing is recorded until then)
+ */
+void startTracing();
+
+/**
+ * @brief Stops recording, the events recorded so far are kept
+ */
+void stopTracing();
+
+/**
+ * @brief Tells if the traced scopes are being recorded
+ */
+inline bool isTracing() {
+	return tracingEnabled.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Records a finished scope in the buffer of the calling thread
+ *
+ * @param name The name of the scope, must outlive the trace (e.g. a string literal)
+ * @param category The category of the scope, must outlive the trace
+ * @param start When the scope started, in microseconds since the program started (see getTraceTime())
+ * @param duration How long it took, in microseconds
+ */
+void recordTraceEvent(const char *name, const char *category, double start, double duration);
+
+/**
+ * @brief The time since the program started, in microseconds
+ */
+double getTraceTime();
+
+/**
+ * @brief Writes the events recorded by all the threads as a Chrome trace (JSON), to open in chrome://tracing or Perfetto
+ * The traced threads shouldn't be recording while it runs
+ *
+ * @param filename The file to write
+ * @return true if the file was written
+ */
+bool writeTrace(const string &filename);
+
+/**
+ * @brief Records the time from its construction to its destruction, if tracing is on when constructed
+ * When tracing is off, it only checks a flag
+ */
+class TraceScope {
+private:
+	const char *name;
+	const char *category;
+	double start;
+
+public:
+	TraceScope(const char *name, const char *category) : name(name), category(category), start(-1) {
+		if (isTracing())
+			start = getTraceTime();
+	}
+
+	~TraceScope() {
+		if (start >= 0)
+			recordTraceEvent(name, category, start, getTraceTime() - start);
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+/**
+ * Traces the rest of the enclosing block, e.g. TRACE_SCOPE("loadNodes", "load");
+ */
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,252 @@
+/**
+ * @brief A GraphViewer window kept open between trips, where only the highlighted trip changes
+ *
+ * @file ViewerSession.cpp
+ */
+#include "ViewerSession.h"
+#include "Trace.h"
+
+const static char STATION_COLOR[] = YELLOW;
+const static char TRIP_STATION_COLOR[] = RED;
+const static int EDGE_THICKNESS = 5;
+const static int TRIP_EDGE_THICKNESS = 12;
+const static int VIEWER_SIZE = 2000;	// the size of the graph in the viewer, the viewport is scaled to it
+const static int WINDOW_SIZE = 1000;
+
+/**
+ * @brief A key for an edge from a station to another, by their viewer IDs
+ */
+static unsigned long long getEdgeKey(int source, int dest)
+{
+	return ((unsigned long long) (unsigned int) source << 32) | (unsigned int) dest;
+}
+
+ViewerSession::ViewerSession(const Graph<string> &g) : g(g), gv(NULL), viewport({0, 0, 0, 0}), numEdges(0)
+{
+}
+
+ViewerSession::~ViewerSession()
+{
+	close();
+}
+
+/**
+ * @brief Tells if the viewer is running
+ */
+bool ViewerSession::isOpen() const
+{
+	return gv != NULL;
+}
+
+/**
+ * @brief Starts the viewer and draws the whole network, at the detail its size allows
+ * The color of the stations by default is set, so the stations of a trip can be put back to it
+ */
+void ViewerSession::open()
+{
+	TRACE_SCOPE("ViewerSession::open", "viewer");
+
+	gv = new GraphViewer(VIEWER_SIZE, VIEWER_SIZE, false);
+	gv->createWindow(WINDOW_SIZE, WINDOW_SIZE);
+
+	// the commands are sent by the viewer's own thread, so drawing and highlighting never wait for the viewer
+	gv->setAsync(true);
+	gv->defineVertexColor(STATION_COLOR);
+
+	numEdges = 0;
+	viewport = getNetworkBounds(g);
+	draw();
+}
+
+/**
+ * @brief Draws the stations and edges of the viewport, placed so the viewport fills the viewer
+ */
+void ViewerSession::draw()
+{
+	TRACE_SCOPE("ViewerSession::draw", "viewer");
+
+	MapView view = buildMapView(g, viewport, WINDOW_SIZE, WINDOW_SIZE);
+	double scale = VIEWER_SIZE / max(max(viewport.maxX - viewport.minX, viewport.maxY - viewport.minY), 1.0);
+
+	drawnAs = view.drawnAs;
+
+	for (size_t i = 0; i < view.stations.size(); i++)
+	{
+		// add the node to graphViewer, with the ID it has in the input files
+		Node<string> *n = g.getNodeByID(view.stations[i]);
+		int viewer_id = g.getOriginalID(n->getId());
+		gv->addNode(viewer_id, (int) ((n->getX() - viewport.minX) * scale), (int) ((n->getY() - viewport.minY) * scale));
+		gv->setVertexSize(viewer_id, 60);
+		if (view.labeled[i])
+			gv->setVertexLabel(viewer_id, n->getInfo());
+		drawnStations.push_back(viewer_id);
+	}
+
+	for (const MapView::Segment &segment : view.segments)
+	{
+		int edge_id = numEdges++;
+		int viewer_id = g.getOriginalID(segment.source);
+		int dest_id = g.getOriginalID(segment.dest);
+		string color = getLineColor(segment.lineID);
+
+		gv->addEdge(edge_id, viewer_id, dest_id, EdgeType::DIRECTED);
+		gv->setEdgeLabel(edge_id, segment.lineID);
+		gv->setEdgeThickness(edge_id, EDGE_THICKNESS);
+		if (!color.empty())
+			gv->setEdgeColor(edge_id, color);
+
+		edgesBetween[getEdgeKey(viewer_id, dest_id)].push_back(make_pair(edge_id, segment.lineID));
+		drawnEdges.push_back(edge_id);
+	}
+}
+
+/**
+ * @brief Removes from the viewer everything drawn by draw()
+ */
+void ViewerSession::erase()
+{
+	TRACE_SCOPE("ViewerSession::erase", "viewer");
+
+	highlightedStations.clear();
+	highlightedEdges.clear();
+
+	for (int id : drawnEdges)
+		gv->removeEdge(id);
+	for (int id : drawnStations)
+		gv->removeNode(id);
+
+	drawnAs.clear();
+	drawnStations.clear();
+	drawnEdges.clear();
+	edgesBetween.clear();
+}
+
+/**
+ * @brief Puts the stations and edges of the trip shown back as they were (the changes aren't sent yet)
+ */
+void ViewerSession::clearPath()
+{
+	for (int id : highlightedStations)
+		gv->setVertexColor(id, STATION_COLOR);
+
+	for (int id : highlightedEdges)
+		gv->setEdgeThickness(id, EDGE_THICKNESS);
+
+	highlightedStations.clear();
+	highlightedEdges.clear();
+}
+
+/**
+ * @brief Shows the whole network, without any trip, starting the viewer if needed
+ */
+void ViewerSession::showMap()
+{
+	if (!isOpen())
+	{
+		open();
+		gv->rearrange();
+		return;
+	}
+
+	Viewport bounds = getNetworkBounds(g);
+	if (bounds.minX != viewport.minX || bounds.minY != viewport.minY || bounds.maxX != viewport.maxX || bounds.maxY != viewport.maxY)
+	{
+		showArea(bounds);
+		return;
+	}
+
+	clearPath();
+	gv->rearrange();
+}
+
+/**
+ * @brief Shows only a part of the map, starting the viewer if needed
+ * What was drawn before is removed, and the stations in the area drawn with the detail its size allows
+ *
+ * @param area The part of the map to show, in the coordinates of the stations
+ */
+void ViewerSession::showArea(const Viewport &area)
+{
+	if (!isOpen())
+		open();
+
+	erase();
+	viewport = area;
+	draw();
+	gv->rearrange();
+}
+
+/**
+ * @brief Highlights a trip on the network, starting the viewer if needed
+ * Only the stations and edges of this trip and of the previous one are changed. Between two stations,
+ * only the edge of the line the trip took is highlighted, not the ones of the other lines along it.
+ *
+ * @param path The stations of the trip, from the arrival to the departure (as in getDetailedPath(), plus the departure)
+ */
+void ViewerSession::showPath(const vector<Node<string> *> &path)
+{
+	TRACE_SCOPE("ViewerSession::showPath", "viewer");
+
+	if (!isOpen())
+		open();
+
+	clearPath();
+
+	// the stations of the trip as they are drawn: outside the viewport they aren't, close together they may be the same one
+	vector<int> stations;
+	vector<string> lines;	// the line the trip took to each station, from the one before in the trip
+	for (Node<string> *n : path)
+	{
+		auto it = drawnAs.find(n->getId());
+		if (it == drawnAs.end())
+			continue;
+
+		// of the stations drawn as one, the trip got to them by the ride to the first one it went through, the last in the path
+		string line = getConnectionLineID(n->getLastConnection());
+
+		int viewer_id = g.getOriginalID(it->second);
+		if (!stations.empty() && stations.back() == viewer_id)
+		{
+			lines.back() = line;
+			continue;
+		}
+
+		stations.push_back(viewer_id);
+		lines.push_back(line);
+		gv->setVertexColor(viewer_id, TRIP_STATION_COLOR);
+		highlightedStations.push_back(viewer_id);
+	}
+
+	for (size_t i = 0; i + 1 < stations.size(); i++)
+	{
+		// the edge the trip took from the next station (the one before, in the trip) to this one, on its line
+		auto it = edgesBetween.find(getEdgeKey(stations[i + 1], stations[i]));
+		if (it == edgesBetween.end())
+			continue;
+
+		for (const pair<int, string> &edge : it->second)
+		{
+			if (edge.second != lines[i])
+				continue;
+
+			gv->setEdgeThickness(edge.first, TRIP_EDGE_THICKNESS);
+			highlightedEdges.push_back(edge.first);
+		}
+	}
+
+	gv->rearrange();
+}
+
+/**
+ * @brief Closes the viewer, if it is running
+ */
+void ViewerSession::close()
+{
+	if (!isOpen())
+		return;
+
+	TRACE_SCOPE("ViewerSession::close", "viewer");
+	gv->closeWindow();
+	delete gv;
+	gv = NULL;
+}
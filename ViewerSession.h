@@ -0,0 +1,59 @@
+/**
+ * @brief A GraphViewer window kept open between trips, where only the highlighted trip changes
+ *
+ * @file ViewerSession.h
+ */
+#ifndef VIEWERSESSION_H_
+#define VIEWERSESSION_H_
+
+#include "Graph.h"
+#include "MapRenderer.h"
+#include "GraphViewer/graphviewer.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * @brief A GraphViewer session over the whole network
+ *
+ * The viewer is started, and the network drawn, only the first time the map is shown. Afterwards, showing a trip
+ * only sends the differences: the stations and edges of the previous trip go back to their color and thickness,
+ * then the ones of the new trip are highlighted.
+ * Only a viewport of the map is drawn, with the detail its zoom allows (see buildMapView()), so the number of
+ * commands sent depends on the size of the window, not on the size of the network.
+ */
+class ViewerSession {
+private:
+	const Graph<string> &g;
+	GraphViewer *gv;
+
+	Viewport viewport;	// the part of the map drawn
+	int numEdges;		// edges added since the viewer started, the next one gets this viewer ID
+	unordered_map<unsigned int, unsigned int> drawnAs;	// node ID of each station in the viewport -> node ID of the one drawn for it
+	vector<int> drawnStations;	// the viewer IDs of the stations drawn
+	vector<int> drawnEdges;		// the viewer IDs of the edges drawn
+	unordered_map<unsigned long long, vector<pair<int, string> > > edgesBetween;	// the viewer IDs of the edges from a station to another, with their line
+	vector<int> highlightedStations;	// the viewer IDs of the stations of the trip shown
+	vector<int> highlightedEdges;		// the viewer IDs of the edges of the trip shown
+
+	void open();
+	void draw();
+	void erase();
+	void clearPath();
+
+public:
+	explicit ViewerSession(const Graph<string> &g);
+	ViewerSession(const ViewerSession &) = delete;
+	ViewerSession &operator=(const ViewerSession &) = delete;
+	~ViewerSession();
+
+	bool isOpen() const;
+	void showMap();
+	void showArea(const Viewport &area);
+	void showPath(const vector<Node<string> *> &path);
+	void close();
+};
+
+#endif /* VIEWERSESSION_H_ */
@@ -6,6 +6,7 @@
 #include "menu.h"
 #include <vector>
 #include <cmath>
+#include <climits>
 
 /*
 	+-----------------------+
@@ -51,7 +52,30 @@ static int getMenuOptionInput(int lower_bound, int upper_bound, string out_quest
 	return opt;
 }
 
-void menu(Graph<string> &g)
+/**
+ * @brief Gets a position (x and y coordinates) from the user
+ *
+ * @param out_question The question to display to the user
+ * @param x Where to put the x coordinate
+ * @param y Where to put the y coordinate
+ */
+static void getPositionInput(string out_question, double &x, double &y)
+{
+	bool success = false;
+
+	do
+	{
+		cout << out_question << " (x y) ? ";
+		cin >> x >> y;
+
+		success = !cin.fail();
+		cin.clear();
+		cin.ignore(1000, '\n');
+
+	} while (!success);
+}
+
+void menu(Graph<string> &g, const StationIndex &index)
 {
 
 	cout << "\n\nWELCOME TO TRIP PLANNER! \n\n";
@@ -59,51 +83,64 @@ void menu(Graph<string> &g)
 	getchar();
 	bool exit = false;
 
+	// started the first time a map is shown
+	ViewerSession viewer(g);
+
 	while (!exit)
 	{
-		menuStart(g);
+		menuStart(g, index, viewer);
 		exit = menuWantToExit();
 	}
 
+	viewer.close();
+
 	cout << "\n\nClosing...\n";
 }
 
-void menuStart(Graph<string> &g)
+void menuStart(Graph<string> &g, const StationIndex &index, ViewerSession &viewer)
 {
 	int option;
 	cout << "\n\n";
 	cout << "Do you want to: \n";
 	cout << "[0] - View the full map\n";
 	cout << "[1] - Plan the trip\n";
-	cout << "[2] - View information of a stop\n\n";
+	cout << "[2] - View information of a stop\n";
+	cout << "[3] - Plan the trip between two positions\n";
+	cout << "[4] - View the map around a position\n\n";
 
-	option = getMenuOptionInput(0, 2, "Option ? ");
+	option = getMenuOptionInput(0, 4, "Option ? ");
 
 	if (option == 0){
-		showGraphViewer(g);
+		viewer.showMap();
 	}
 	else if(option == 1){
-		menuTripPlanning(g);
+		menuTripPlanning(g, index, viewer);
+	}
+	else if(option == 3){
+		menuLocationTripPlanning(g);
+	}
+	else if(option == 4){
+		menuMapArea(viewer);
 	}
 	else{
-		menuFindLineInStation(g);
+		menuFindLineInStation(g, index);
 	}
 
 }
 
-void menuTripPlanning(Graph<string> &g)
+void menuTripPlanning(Graph<string> &g, const StationIndex &index, ViewerSession &viewer)
 {
 	// ask for departure station
 	int id_origin, id_dest;
 
 	do
 	{
-		id_origin = getStationInput(g, "Departure Station");
+		id_origin = getStationInput(index, "Departure Station");
 	} while (id_origin == -1);
 
 	do
 	{
-		id_dest = getStationInput(g, "Arrival station");
+		id_dest = getStationInput(index, "Arrival station");
 	} while (id_dest == -1);
 
 	// Get node pointers
@@ -124,28 +161,69 @@ void menuTripPlanning(Graph<string> &g)
 
 	showShortTripPath(t);
 
-	// Show map (Graph Viewer)
+	// Show map (Graph Viewer), changing only the highlighted trip if it is already open
 	if (invertedPath.at(0)->getLastNode() != NULL)
 	{
 		invertedPath.push_back(startNode);
-		GraphViewer *gv = buildGraphViewerDeatiledPath(g, invertedPath);
+		viewer.showPath(invertedPath);
+	}
+}
 
-		cout << "\nPress any key to close window ...\n";
-		cin.ignore(1000, '\n');
-		getchar();
+void menuLocationTripPlanning(Graph<string> &g)
+{
+	double startX, startY, endX, endY;
+
+	getPositionInput("Departure position", startX, startY);
+	getPositionInput("Arrival position", endX, endY);
+
+	// the fastest trip, walking to and from the stations near each position
+	Node<string> *arrival = g.dijkstra_queue_LOCATIONS(startX, startY, endX, endY);
 
-		gv->closeWindow();
+	if (arrival == NULL)
+	{
+		cout << "There are no stations near those positions!\n";
+		return;
 	}
+
+	vector<Node<string> *> invertedPath = g.getDetailedPath(arrival);
+
+	Node<string> *departure = arrival;
+	while (departure->getLastNode() != NULL)
+		departure = departure->getLastNode();
+
+	double startWalk = departure->getWalkTime(startX, startY);
+	double endWalk = arrival->getWalkTime(endX, endY);
+
+	cout << "Walk to " << departure->getInfo() << " (" << round(startWalk * 100) / 100 << " minutes)\n";
+
+	if (departure != arrival)
+		g.presentPath(invertedPath);
+
+	cout << "Walk from " << arrival->getInfo() << " to the arrival position ("
+		 << round(endWalk * 100) / 100 << " minutes)\n";
+	cout << "\nTotal Time, walking included: " << round((arrival->getDistance() + endWalk) * 100) / 100
+		 << " minutes.\n";
+}
+
+void menuMapArea(ViewerSession &viewer)
+{
+	double x, y;
+
+	getPositionInput("Center of the map", x, y);
+	int size = getMenuOptionInput(1, INT_MAX, "Size of the area shown ? ");
+
+	Viewport area = {x - size / 2.0, y - size / 2.0, x + size / 2.0, y + size / 2.0};
+	viewer.showArea(area);
 }
 
-void menuFindLineInStation(Graph<string> &g){
+void menuFindLineInStation(Graph<string> &g, const StationIndex &index){
 
 	int stationID;
 	string lineID;
 
 	// ask for station's name
 	do{
-		stationID = getStationInput(g, "Station");
+		stationID = getStationInput(index, "Station");
 	} while (stationID == -1);
 
 	// ask for line's name
@@ -153,21 +231,14 @@ void menuFindLineInStation(Graph<string> &g){
 	getline(cin, lineID);
 
 	// find the station in specified line
-	map<string, set<unsigned int>> stationsByLine = g.getStationsByLine();
-	auto lineIt = stationsByLine.find(lineID);
+	const LineIndex &lines = g.getLineIndex();
+	int line = lines.getLine(lineID);
 
-	if(lineIt == stationsByLine.end()) {
+	if(line == -1) {
 		cout << "The line " << lineID << " does not exist!\n";
 	} else {
-		// found line, get the iterator for stations of that line
-		bool found = false;
-		for(auto stationIt = lineIt->second.begin(); stationIt != lineIt->second.end() && !found; stationIt++) {
-			if(*stationIt == (unsigned int)stationID) // at this point, stationID is > 0
-				found = true;
-		}
-
 		// display message
-		if(found){
+		if(lines.serves(line, stationID)){ // at this point, stationID is > 0
 		cout << "The line " << lineID << " passes in this station";
 		}
 		else{
@@ -190,15 +261,12 @@ bool menuWantToExit()
 
 bool valideUserInput(string input){
 
-	vector<string> tokens = tokenize(input);
-
-	removeWordsFromDictionary(tokens);
-
-	return !tokens.empty();
+	// the same words the station index searches for
+	return !normalizeName(input).empty();
 
 }
 
-int getStationInput(Graph<string> &g, string initialMessage) {
+int getStationInput(const StationIndex &index, string initialMessage) {
 	// get user station input
 	string stationInput;
 	cout << initialMessage << ": ";
@@ -211,117 +279,41 @@ int getStationInput(Graph<string> &g, string initialMessage) {
 		return -1;
 	}
 
-	// containers initialization
-	vector<Node<string> *> stations = g.getNodes();
-	vector<Node<string> *> matchedStations;
-	set<Guess *, cmpGuess> approximateGuesses;
-
-	/**
-	 * Exact Search
-	 */
-
-	for(Node<string>* station : stations) {
-		if(kmpMatcher(station->getInfo(), stationInput))
-			matchedStations.push_back(station);
-	}
-
-	// call getStationUserChoice here
-	int userChoice;
-
-	if((userChoice = getStationUserChoice(matchedStations)) != -1)
-		return userChoice; // user could pick a station
-
-	// assuming match string failed, try aproximate search
-
-	/**
-	 * Approximate Search
-	 * Now using the set
-	 */
-	// set the maximum distance between map stations name and user input
-	int maxDiff = stationInput.length() * 0.60;
-
-	for(Node<string>* station : stations) {
-		int distance = editDistance(station->getInfo(), stationInput);
-
-		if(distance <= maxDiff){
-
-			Guess * g = new Guess();
-			g->editDistance = distance;
-			g->index = station->getId();
-			g->stationName = station->getInfo();
-
-			approximateGuesses.insert(g);
-
-		}
-	
-	}
-
-	if((userChoice = getStationUserApproximateChoice(approximateGuesses)) != -1)
-		return userChoice; // user could pick a station
-
-
-	/**
-	 * Token Search
-	 */
-
-	//If we couldn't find it using the normal, try to tokenize it
-	matchedStations.clear();
-	for(Node<string>* station : stations) {
-		if(tokenizeAndSearch(station->getInfo(), stationInput) == 0)
-			matchedStations.push_back(station);
-	}
-	return getStationUserChoice(matchedStations);
+	// exact, approximate and token matches, all ranked together
+	return getStationUserChoice(index.suggestStations(stationInput, MAX_SUGGESTIONS));
 }
 
 
-int getStationUserApproximateChoice(const set<Guess *, cmpGuess> & approximateGuesses)
+int getStationUserChoice(const vector<StationSuggestion> &suggestions)
 {
-
-	if(!approximateGuesses.empty()) {
-		cout << "We could't find your station. Did you mean:\n";
-		int i = 0;
-		for (auto it = approximateGuesses.begin(); it != approximateGuesses.end() && i < 4; it++, i++){
-				cout << "[" << i << "]"
-					 << " - " << (*it)->stationName << endl;
-		}
-			cout << "[" << i << "]"
-					 << " - " << "None of the Above. Try advanced search." << endl;
-
-		int option = getMenuOptionInput(0, i, " -->Select your choice:");
-
-		if(option == i){
-			return -1;
-		}
-
-		auto result = next(approximateGuesses.begin(), option);
-		return (*result)->index;
-	}
-	else 
+	if(suggestions.empty()) {
+		cout << "We could't find your station.\n";
 		return -1;
-}
+	}
 
+	bool singleExact = suggestions.front().match == EXACT_MATCH
+			&& (suggestions.size() == 1 || suggestions.at(1).match != EXACT_MATCH);
 
-int getStationUserChoice(const vector<Node<string> *> &matchedStations)
-{
+	if(singleExact) {
+		cout << "Station acknowledged: " << suggestions.front().name << "\n";
+		return suggestions.front().id;
+	}
 
-	if(matchedStations.size() == 1) {
-		cout << "Departure Station acknowledge: " << matchedStations.front()->getInfo() << "\n";
-		return matchedStations.front()->getId(); 
+	cout << "We could't find your station. Did you mean:\n";
+	int i = 0;
+	for (auto it = suggestions.begin(); it != suggestions.end(); it++, i++){
+		cout << "[" << i << "]"
+			 << " - " << it->name << endl;
 	}
-	else if(matchedStations.size() > 1) {
-		cout << "We could't find your station. Did you mean:\n";
-		int i = 0;
-		for (auto it = matchedStations.begin(); it != matchedStations.end() && i < 4; it++, i++){
-				cout << "[" << i << "]"
-					 << " - " << (*it)->getInfo() << endl;
-		}
+	cout << "[" << i << "]"
+		 << " - " << "None of the Above. Try again." << endl;
 
-		int option = getMenuOptionInput(0, i, " -->Select your choice:");
+	int option = getMenuOptionInput(0, i, " -->Select your choice:");
 
-		return (*(matchedStations.begin() + option))->getId();
-	}
-	else 
+	if(option == i)
 		return -1;
+
+	return suggestions.at(option).id;
 }
 
 pathCriterion getPathCriterion()
@@ -427,90 +419,3 @@ Node<string> *run_Dijkstra(Graph<string> &g, Node<string> *startNode,
 		return NULL;
 	}
 }
-
-/*
-	+-----------------------+
-	|                       |
-	|      Graph Viewer     |
-	|                       |
-	+-----------------------+
-*/
-
-void showGraphViewer(Graph<string> &g)
-{
-	GraphViewer *gv = buildGraphViewer(g);
-
-	cout << "Press any key to close window ...\n";
-	getchar();
-	gv->closeWindow();
-}
-
-GraphViewer *buildGraphViewer(Graph<string> &g)
-{
-	GraphViewer *gv = new GraphViewer(2000, 2000, false);
-	gv->createWindow(1000, 1000);
-
-	// edge id's
-	int edge_id = 0;
-	// Get the nodes
-	vector<Node<string> *> nodes = g.getNodes();
-	for (size_t i = 0; i < nodes.size(); i++)
-	{
-		// add the node to graphViewer
-		Node<string> *n = nodes.at(i);
-		gv->addNode(n->getId(), n->getX() / 2, n->getY() / 2);
-		gv->setVertexSize(n->getId(), 60);
-		gv->setVertexLabel(n->getId(), n->getInfo());
-
-		// add  the edges (this might not work because not all nodes are defined yet)
-		vector<Edge<string>> edges = nodes.at(i)->getEdges();
-		for (size_t j = 0; j < edges.size(); j++)
-		{
-			if (edges.at(j).getType() != "walk")
-			{
-				gv->addEdge(edge_id, n->getId(), edges.at(j).getDestiny()->getId(), EdgeType::DIRECTED);
-				gv->setEdgeLabel(edge_id, edges.at(j).getLineID());
-				gv->setEdgeThickness(edge_id, 5);
-
-				setGraphViewerEdgeColor(gv, edge_id, edges.at(j).getLineID());
-
-				edge_id++;
-			}
-		}
-
-		gv->rearrange();
-	}
-
-	gv->rearrange();
-	return gv;
-}
-
-GraphViewer *buildGraphViewerDeatiledPath(Graph<string> &g, vector<Node<string> *> nodes)
-{
-	// build the whole map
-	GraphViewer *gv = buildGraphViewer(g);
-
-	// Change path nodes color
-	for (size_t i = 0; i < nodes.size(); i++)
-	{
-		gv->setVertexColor(nodes.at(i)->getId(), RED);
-	}
-
-	return gv;
-}
-
-void setGraphViewerEdgeColor(GraphViewer *gv, int edge_id, string lineID)
-{
-	if (lineID == "B")
-		gv->setEdgeColor(edge_id, RED);
-	else if (lineID == "F")
-		gv->setEdgeColor(edge_id, ORANGE);
-	else if (lineID == "D")
-		gv->setEdgeColor(edge_id, YELLOW);
-	else if (lineID == "401")
-		gv->setEdgeColor(edge_id, GREEN);
-	else if (lineID == "204")
-		gv->setEdgeColor(edge_id, CYAN);
-	else if (lineID == "803")
-		gv->setEdgeColor(edge_id, MAGENTA);
-}
\ No newline at end of file
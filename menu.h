@@ -10,6 +10,13 @@
 #include "GraphViewer/graphviewer.h"
 #include <string>
 #include "stringSearch.h"
+#include "StationIndex.h"
+#include "ViewerSession.h"
+
+/**
+ * Number of stations suggested to the user when looking up a station
+ */
+const unsigned int MAX_SUGGESTIONS = 4;
 
 enum pathCriterion
 {
@@ -21,31 +28,53 @@ enum pathCriterion
 
 /**
  * @brief The main menu
+ * The map window, once open, is kept open until the program ends
  *
  * @param g The graph where this menu operates on
+ * @param index The index of the station names
  */
-void menu(Graph<string>& g);
+void menu(Graph<string> &g, const StationIndex &index);
 
 /**
  * @brief Menu that allows to view the map, or plan a trip
  *
  * @param g The graph where this menu operates on
+ * @param index The index of the station names
+ * @param viewer The map window
  */
-void menuStart(Graph<string>& g);
+void menuStart(Graph<string> &g, const StationIndex &index, ViewerSession &viewer);
 
 /**
  * @brief Menu where the user is asked to choose the departure/arrival stations
  *
  * @param g The graph where this menu operates on
+ * @param index The index of the station names
+ * @param viewer The map window, where the trip is shown
+ */
+void menuTripPlanning(Graph<string> &g, const StationIndex &index, ViewerSession &viewer);
+
+/**
+ * @brief Menu where the user is asked for the departure/arrival positions, and gets the trip through the nearest stations
+ *
+ * @param g The graph where this menu operates on
+ */
+void menuLocationTripPlanning(Graph<string> &g);
+
+/**
+ * @brief Menu where the user is asked for a position and a size, and the map is shown around that position
+ * The smaller the area, the more stations and names are shown
+ *
+ * @param viewer The map window
  */
-void menuTripPlanning(Graph<string> &g);
+void menuMapArea(ViewerSession &viewer);
 
 /**
  * @brief Menu where the user is asked to choose a station and a Line and receives information whether the line passes or not in the station
  *
  * @param g The graph where this menu operates on
+ * @param index The index of the station names
  */
-void menuFindLineInStation(Graph<string> &g);
+void menuFindLineInStation(Graph<string> &g, const StationIndex &index);
 
 /**
  * @brief Asks the user if he wants to continue using Trip Planner or exit the program
@@ -58,31 +87,24 @@ bool menuWantToExit();
 /**
  * @brief Get the Station ID from user input
  * To correctly pick a station, the function uses different string matching algorithms
- * @param g The graph
+ * @param index The index of the station names
  * @param initialMessage A message to describe the type of input (e.g. "Enter departure station")
  * @return unsigned int The graph's node id that matches the station user input. If no match is found, returns -1
  */
-int getStationInput(Graph<string> &g, string initialMessage);
+int getStationInput(const StationIndex &index, string initialMessage);
 
 /**
- * @brief This function lists stations and asks the user to pick one
+ * @brief This function lists the suggested stations and asks the user to pick one
+ * A single station whose name contains the user input is picked without asking
  * 
- * @param matchedStations A vector of pointers to Nodes (stations)
- * @return int The node ID of the picked station. If the vector is empty, returns -1
+ * @param suggestions The suggestions, from the best to the worst
+ * @return int The node ID of the picked station. If there are no suggestions, or the user picks none, returns -1
  */
-int getStationUserChoice(const vector<Node<string> *> &matchedStations);
+int getStationUserChoice(const vector<StationSuggestion> &suggestions);
 
 /**
- * @brief This function lists stations and asks the user to pick one, after an approximate search was done
- * 
- * @param matchedStations A set of Guess pointers 
- * @return int The node ID of the picked station. If the vector is empty, returns -1
- */
-int getStationUserApproximateChoice(const set<Guess *, cmpGuess> & approximateGuesses);
-
-/**
- * @brief Valides the user input by tokenizing it and removing all the words from our common dictionary
- * If the resulting vector of tokens if empty, the string is not valid
+ * @brief Valides the user input by normalizing it like the station names (see normalizeName())
+ * If nothing is left, i.e. it only has words from our common dictionary, the string is not valid
  * 
  * @param userInput - the string to be validated
  * @return true if valid, false otherwise
@@ -123,33 +145,4 @@ void showShortTripPath(vector<string> t);
  */
 Node<string>* run_Dijkstra(Graph<string>& g, Node<string>* startNode, Node<string>* endNode, pathCriterion criterion);
 
-
-/*
-	+-----------------------+
-	|                       |
-	|      Graph Viewer     |
-	|                       |
-	+-----------------------+
-*/
-
-/**
- * @brief Shows a graphViewer map showing all stations and connections in between
- */
-void showGraphViewer(Graph<string>& g);
-
-/**
- * @brief Builds and returns a GraphViewer with all stations and connections
- */
-GraphViewer* buildGraphViewer(Graph<string>& g);
-
-/**
- * @brief Builds and returns a GraphViewer with all stations and connections, but highlighting some path
- */
-GraphViewer* buildGraphViewerDeatiledPath(Graph<string>& g, vector<Node<string>*> nodes);
-
-/**
- * @brief Determines GraphViewer edge's colors based on it's lineID
- */
-void setGraphViewerEdgeColor(GraphViewer *gv, int edge_id, string lineID);
-
 #endif
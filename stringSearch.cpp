@@ -4,18 +4,29 @@
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 const static std::vector<std::string> myDictionary = {"a", "o", "as", "os", "de", "da", "do"};
 
-void computerPrefixFunction(std::string toSearch, int pi[]) {
+void computerPrefixFunction(std::string_view toSearch, int pi[]) {
 	int m = toSearch.length();
+	if (m == 0)
+		return;
+
 	pi[0] = 0;
 	int k = 0;
 
 	for (int q = 1; q < m; q++) {
 		while (k > 0 && toSearch[k] != toSearch[q])
 			k = pi[k - 1];
-		if (tolower(toSearch[k]) == tolower(toSearch[q]))
+		if (toSearch[k] == toSearch[q])
 			k++;
 		pi[q] = k;
 	}
@@ -24,21 +35,29 @@ void computerPrefixFunction(std::string toSearch, int pi[]) {
 }
 
 
-int kmpMatcher(std::string text, std::string pattern) {
+int kmpMatcher(std::string_view text, std::string_view pattern) {
+	// only the prefix table, the edit distance tables of a CompiledPattern aren't needed here
+	std::vector<int> pi(pattern.length());
+	computerPrefixFunction(pattern, pi.data());
+
+	return kmpMatcher(text, pattern, pi.data());
+}
+
+int kmpMatcher(std::string_view text, std::string_view pattern, const int pi[]) {
 	int n = text.length();
 	int m = pattern.length();
 
-	int pi[m];
-	computerPrefixFunction(pattern, pi);
+	if (m == 0)
+		return 0;
 
 	int i = 0, q = 0, result = 0;
 
 	for (; i < n; i++) {
 
-		while (q > 0 && pattern.at(q) != text.at(i))
+		while (q > 0 && pattern[q] != text[i])
 			q = pi[q - 1];
 
-		if (tolower(pattern.at(q)) == tolower(text.at(i)))
+		if (pattern[q] == text[i])
 			q++;
 
 		if (q == m) {
@@ -51,31 +70,68 @@ int kmpMatcher(std::string text, std::string pattern) {
 	return result;
 }
 
-int kmpMatcher(std::string text, std::string pattern, int pi[]) {
-	int n = text.length();
-	int m = pattern.length();
-
-	int i = 0, q = 0, result = 0;
+/**
+ * @brief Finds the first occurrence of a pattern in a text, from a certain position
+ *
+ * Only the positions where both the first and the last character of the pattern match are compared in full.
+ * With SSE2, those are found 16 positions at a time: two loads of the text, m - 1 bytes apart, compared with the
+ * first and the last character. The positions left at the end (or all of them, without SSE2) are checked one at a time.
+ *
+ * @return The position of the occurrence, or std::string_view::npos if there is none
+ */
+static size_t findOccurrence(std::string_view text, std::string_view pattern, size_t from) {
+	size_t n = text.length();
+	size_t m = pattern.length();
+
+	if (m == 0 || m > n)
+		return m == 0 && from <= n ? from : std::string_view::npos;
+
+	size_t end = n - m + 1;	// one past the last position where the pattern fits
+	size_t i = from;
+	const char *t = text.data();
+	const char *p = pattern.data();
+
+#ifdef __SSE2__
+	const __m128i first = _mm_set1_epi8(p[0]);
+	const __m128i last = _mm_set1_epi8(p[m - 1]);
+
+	for (; i + 16 <= end; i += 16) {
+		__m128i blockFirst = _mm_loadu_si128((const __m128i *) (t + i));
+		__m128i blockLast = _mm_loadu_si128((const __m128i *) (t + i + m - 1));
+
+		unsigned int mask = _mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+
+		while (mask != 0) {
+			unsigned int bit = __builtin_ctz(mask);
+			if (memcmp(t + i + bit, p, m) == 0)
+				return i + bit;
+			mask &= mask - 1;
+		}
+	}
+#endif
 
-	for (; i < n; i++) {
+	for (; i < end; i++)
+		if (t[i] == p[0] && t[i + m - 1] == p[m - 1] && memcmp(t + i, p, m) == 0)
+			return i;
 
-		while (q > 0 && pattern.at(q) != text.at(i))
-			q = pi[q - 1];
+	return std::string_view::npos;
+}
 
-		if (tolower(pattern.at(q)) == tolower(text.at(i)))
-			q++;
+int simdMatcher(std::string_view text, std::string_view pattern) {
+	if (pattern.empty())
+		return 0;
 
-		if (q == m) {
-			result++;
-			q = pi[q - 1];
-		}
+	int result = 0;
 
-	}
+	// like kmpMatcher(), overlapping occurrences count
+	for (size_t i = findOccurrence(text, pattern, 0); i != std::string_view::npos; i = findOccurrence(text, pattern, i + 1))
+		result++;
 
 	return result;
 }
 
-int editDistance(std::string text, std::string pattern) {
+int editDistanceDP(std::string text, std::string pattern) {
 
 	int m = pattern.length();
 	int n = text.length();
@@ -89,7 +145,7 @@ int editDistance(std::string text, std::string pattern) {
 		cur[0] = j;
 		for (int i = 1; i <= m; i++) {
 			int temp = cur[i];
-			if (tolower(pattern.at(i - 1)) == tolower(text.at(j - 1)))
+			if (pattern.at(i - 1) == text.at(j - 1))
 				cur[i] = pre;
 			else
 				cur[i] = std::min(pre + 1,
@@ -101,6 +157,235 @@ int editDistance(std::string text, std::string pattern) {
 
 }
 
+/**
+ * @brief Advances one block of 64 rows of the edit distance matrix by one column (Myers' step, Hyyro's formulation)
+ *
+ * The block is kept as its vertical differences: bit i of Pv (Mv) is set if the cell i is one more (less) than the one above.
+ *
+ * @param Pv The positive vertical differences of the block
+ * @param Mv The negative vertical differences of the block
+ * @param Eq The rows of the block whose pattern character matches the text character
+ * @param hin The horizontal difference (-1, 0 or +1) of the row above the block
+ * @param lastRow The row whose horizontal difference is returned
+ * @return The horizontal difference of lastRow
+ */
+static int advanceBlock(uint64_t &Pv, uint64_t &Mv, uint64_t Eq, int hin, uint64_t lastRow) {
+
+	uint64_t Xv = Eq | Mv;
+
+	if (hin < 0)
+		Eq |= 1;
+
+	uint64_t Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+	uint64_t Ph = Mv | ~(Xh | Pv);
+	uint64_t Mh = Pv & Xh;
+
+	int hout = 0;
+	if (Ph & lastRow)
+		hout = 1;
+	else if (Mh & lastRow)
+		hout = -1;
+
+	Ph <<= 1;
+	Mh <<= 1;
+
+	if (hin < 0)
+		Mh |= 1;
+	else if (hin > 0)
+		Ph |= 1;
+
+	Pv = Mh | ~(Xv | Ph);
+	Mv = Ph & Xv;
+
+	return hout;
+}
+
+/**
+ * @brief Fills the table of the rows where each character occurs in the pattern, for each block of 64 rows
+ *
+ * @param Peq The table, 256 * numBlocks words, all zero
+ */
+static void buildPeq(std::string_view pattern, uint64_t *Peq, int numBlocks) {
+	for (size_t i = 0; i < pattern.length(); i++)
+		Peq[(unsigned char) pattern[i] * numBlocks + i / 64] |= uint64_t(1) << (i % 64);
+}
+
+/**
+ * @brief Bit-parallel edit distance, with the pattern split in blocks of 64 characters
+ *
+ * @param Peq The rows of each block where each character occurs, see buildPeq()
+ * @param m The length of the pattern
+ * @param maxDiff Stop as soon as the distance is known to be bigger than this
+ * @param anywhere If true, the distance to the closest substring of the text (the first row of the matrix is all zeros)
+ * @return The distance, or maxDiff + 1 if it is bigger than maxDiff
+ */
+static int blockEditDistance(std::string_view text, const uint64_t *Peq, int m, int maxDiff, bool anywhere) {
+
+	int n = text.length();
+	int numBlocks = (m + 63) / 64;
+
+	std::vector<uint64_t> Pv(numBlocks, ~uint64_t(0));
+	std::vector<uint64_t> Mv(numBlocks, 0);
+
+	const uint64_t blockEnd = uint64_t(1) << 63;
+	const uint64_t patternEnd = uint64_t(1) << ((m - 1) % 64);
+
+	int score = m;
+	int best = m;
+
+	// a substring at distance 0 can't be beaten, but the whole text still has to be read for the full distance
+	for (int j = 0; j < n && !(anywhere && best == 0); j++) {
+		const uint64_t *Eq = &Peq[(unsigned char) text[j] * numBlocks];
+
+		// the first row of the matrix grows by one in every column, unless the match can start anywhere
+		int h = anywhere ? 0 : 1;
+		for (int b = 0; b < numBlocks; b++)
+			h = advanceBlock(Pv[b], Mv[b], Eq[b], h, b == numBlocks - 1 ? patternEnd : blockEnd);
+
+		score += h;
+		best = std::min(best, score);
+
+		// the last row changes by at most one per column, so it can't come back under maxDiff
+		if (!anywhere && score - (n - j - 1) > maxDiff)
+			return maxDiff + 1;
+	}
+
+	if (anywhere)
+		score = best;
+
+	return score <= maxDiff ? score : maxDiff + 1;
+}
+
+/**
+ * @brief Bit-parallel edit distance for patterns of up to 64 characters, all in a single word
+ *
+ * @param Peq The rows where each character occurs, see buildPeq()
+ * @param m The length of the pattern
+ * @param maxDiff Stop as soon as the distance is known to be bigger than this
+ * @param anywhere If true, the distance to the closest substring of the text (the first row of the matrix is all zeros)
+ * @return The distance, or maxDiff + 1 if it is bigger than maxDiff
+ */
+static int wordEditDistance(std::string_view text, const uint64_t Peq[256], int m, int maxDiff, bool anywhere) {
+
+	int n = text.length();
+
+	uint64_t Pv = ~uint64_t(0);
+	uint64_t Mv = 0;
+	const uint64_t patternEnd = uint64_t(1) << (m - 1);
+
+	int score = m;
+	int best = m;
+
+	for (int j = 0; j < n && !(anywhere && best == 0); j++) {
+		score += advanceBlock(Pv, Mv, Peq[(unsigned char) text[j]], anywhere ? 0 : 1, patternEnd);
+		best = std::min(best, score);
+
+		if (!anywhere && score - (n - j - 1) > maxDiff)
+			return maxDiff + 1;
+	}
+
+	if (anywhere)
+		score = best;
+
+	return score <= maxDiff ? score : maxDiff + 1;
+}
+
+/**
+ * @brief Bit-parallel edit distance of a pattern that isn't used again, its table on the stack if it fits in a word
+ */
+static int myersEditDistance(std::string_view text, std::string_view pattern, int maxDiff, bool anywhere) {
+
+	int m = pattern.length();
+
+	if (m <= 64) {
+		uint64_t Peq[256] = {0};
+		buildPeq(pattern, Peq, 1);
+		return wordEditDistance(text, Peq, m, maxDiff, anywhere);
+	}
+
+	int numBlocks = (m + 63) / 64;
+	std::vector<uint64_t> Peq(256 * numBlocks, 0);
+	buildPeq(pattern, Peq.data(), numBlocks);
+	return blockEditDistance(text, Peq.data(), m, maxDiff, anywhere);
+}
+
+int editDistance(std::string_view text, std::string_view pattern, int maxDiff) {
+
+	int m = pattern.length();
+	int n = text.length();
+
+	if (abs(m - n) > maxDiff)
+		return maxDiff + 1;
+
+	if (m == 0)
+		return n;
+
+	return myersEditDistance(text, pattern, maxDiff, false);
+}
+
+int editDistance(std::string_view text, std::string_view pattern) {
+	return editDistance(text, pattern, std::numeric_limits<int>::max() - 1);
+}
+
+int substringEditDistance(std::string_view text, std::string_view pattern, int maxDiff) {
+
+	if (pattern.empty())
+		return 0;
+
+	return myersEditDistance(text, pattern, maxDiff, true);
+}
+
+CompiledPattern::CompiledPattern(std::string_view pattern) :
+		pattern(pattern), pi(pattern.length()), numBlocks((pattern.length() + 63) / 64), Peq(256 * numBlocks, 0) {
+
+	computerPrefixFunction(pattern, pi.data());
+	buildPeq(pattern, Peq.data(), numBlocks);
+}
+
+const std::string &CompiledPattern::getPattern() const {
+	return pattern;
+}
+
+unsigned int CompiledPattern::length() const {
+	return pattern.length();
+}
+
+int CompiledPattern::count(std::string_view text) const {
+	return kmpMatcher(text, pattern, pi.data());
+}
+
+bool CompiledPattern::isFoundIn(std::string_view text) const {
+	return findOccurrence(text, pattern, 0) != std::string_view::npos;
+}
+
+int CompiledPattern::editDistance(std::string_view text, int maxDiff) const {
+	int m = pattern.length();
+	int n = text.length();
+
+	if (abs(m - n) > maxDiff)
+		return maxDiff + 1;
+
+	if (m == 0)
+		return n;
+
+	if (numBlocks == 1)
+		return wordEditDistance(text, Peq.data(), m, maxDiff, false);
+
+	return blockEditDistance(text, Peq.data(), m, maxDiff, false);
+}
+
+int CompiledPattern::substringEditDistance(std::string_view text, int maxDiff) const {
+	int m = pattern.length();
+
+	if (m == 0)
+		return 0;
+
+	if (numBlocks == 1)
+		return wordEditDistance(text, Peq.data(), m, maxDiff, true);
+
+	return blockEditDistance(text, Peq.data(), m, maxDiff, true);
+}
+
 std::vector<std::string> tokenize(const std::string &s){
 	std::vector<std::string> result;
 	std::stringstream ss(s);
@@ -115,24 +400,20 @@ int tokenizeAndSearch(std::string stationName, std::string userStationInput)
 {
 	int maxEditDistance = 1;
 
-	// tokenize the station name
-	std::vector<std::string> tokens = tokenize(stationName);
-
-	//tokenize user input
-	std::vector<std::string> userTokens = tokenize(userStationInput);
+	// the station name, without some definite articles, etc.
+	std::string name = normalizeName(stationName);
 
-	// remove some definite articles, etc.
-	removeWordsFromDictionary(tokens);
+	std::string input = foldText(userStationInput);
 
 	size_t matchCounter = 0; 
 
 	// try to find at least one token from station name, where the user input is close enough
-	for (std::string s : tokens){
+	for (std::string_view s : Tokens(name)){
 
-		for(std::string uS : userTokens){
+		for(std::string_view uS : Tokens(input)){
 
 		int sizeDiff = uS.length() - s.length();
-		if (editDistance(uS, s) <= maxEditDistance && (abs(sizeDiff) <= 1))
+		if (abs(sizeDiff) <= 1 && editDistance(uS, s, maxEditDistance) <= maxEditDistance)
 			matchCounter++;
 		}
 	}
@@ -146,11 +427,86 @@ int tokenizeAndSearch(std::string stationName, std::string userStationInput)
 
 void removeWordsFromDictionary(std::vector<std::string> &tokens){
 
-	for (std::string token : myDictionary)
-	{
-		auto it = std::find(tokens.begin(), tokens.end(), token);
+	tokens.erase(std::remove_if(tokens.begin(), tokens.end(), isCommonWord), tokens.end());
+}
+
+bool isCommonWord(std::string_view word){
+	return std::find(myDictionary.begin(), myDictionary.end(), word) != myDictionary.end();
+}
+
+/**
+ * The ASCII letter of each character of the Latin-1 Supplement block (U+00C0 to U+00FF), lower case, 0 if none
+ */
+const static char latinLetters[] =
+	"aaaaaaaceeeeiiii" // U+00C0 - U+00CF
+	"dnooooo\0ouuuuy\0s" // U+00D0 - U+00DF
+	"aaaaaaaceeeeiiii" // U+00E0 - U+00EF
+	"dnooooo\0ouuuuy\0y"; // U+00F0 - U+00FF
+
+std::string foldText(const std::string &s){
+	std::string result;
+	result.reserve(s.length());
+
+	for (size_t i = 0; i < s.length(); i++) {
+		unsigned char c = s[i];
+
+		// two byte UTF-8 sequences from U+00C0 to U+00FF start with 0xC3
+		if (c == 0xC3 && i + 1 < s.length() && (unsigned char) s[i + 1] >= 0x80 && (unsigned char) s[i + 1] <= 0xBF) {
+			char letter = latinLetters[(unsigned char) s[i + 1] - 0x80];
+			if (letter != 0) {
+				result += letter;
+				i++;
+				continue;
+			}
+		}
+
+		result += (c < 0x80) ? (char) tolower(c) : (char) c;
+	}
+
+	return result;
+}
+
+std::string normalizeName(const std::string &s){
+	std::string folded = foldText(s);
+
+	std::string result;
+	result.reserve(folded.length());
 
-		if (it != tokens.end())
-			tokens.erase(it);
+	for (std::string_view word : Tokens(folded)) {
+		if (isCommonWord(word))
+			continue;
+		if (!result.empty())
+			result += ' ';
+		result += word;
 	}
-}
\ No newline at end of file
+
+	return result;
+}
+
+Tokens::Tokens(std::string_view text) : text(text) {
+}
+
+Tokens::iterator Tokens::begin() const {
+	return iterator(text);
+}
+
+Tokens::iterator Tokens::end() const {
+	return iterator(std::string_view());
+}
+
+Tokens::iterator::iterator(std::string_view rest) : rest(rest) {
+	advance();
+}
+
+void Tokens::iterator::advance() {
+	size_t start = rest.find_first_not_of(' ');
+	if (start == std::string_view::npos) {
+		rest = word = std::string_view();
+		return;
+	}
+
+	size_t end = std::min(rest.find(' ', start), rest.length());
+	word = rest.substr(start, end - start);
+	rest = rest.substr(end);
+}
+
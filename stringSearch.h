@@ -1,23 +1,11 @@
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdint>
 
-/** 
-* Struct containing the essential info for the string searching algorithmns 
-*/ 
-typedef struct{
-  std::string stationName; ///< the stop name 
-  int index;         ///< the stop index in the Graph's vector 
-  int editDistance;  ///< it's current editDistance 
-}Guess;
-
-/**
- * < operator for Guess 
+/*
+ * The matchers compare plain bytes: the texts are expected to be normalized already, see normalizeName()
  */
-struct cmpGuess{ 
-   bool operator()(Guess * a,  Guess * b) const { 
-        return a->editDistance < b->editDistance; 
-    } 
-}; 
 
 /**
  * @brief The KMP prefix pre-processing algorithm
@@ -25,7 +13,7 @@ struct cmpGuess{
  * @param toSearch The pattern to be searched
  * @param pi A reference for the prefix-table to be filled
  */
-void computerPrefixFunction(std::string toSearch, int pi[]);
+void computerPrefixFunction(std::string_view toSearch, int pi[]);
 
 /**
  * @brief KMP Matching algorithm
@@ -34,7 +22,7 @@ void computerPrefixFunction(std::string toSearch, int pi[]);
  * @param pattern The pattern to be found in text
  * @retval The number of pattern ocurrences in text
  */
-int kmpMatcher(std::string text, std::string pattern);
+int kmpMatcher(std::string_view text, std::string_view pattern);
 
 /**
  * @see kmpMatcher
@@ -44,24 +32,141 @@ int kmpMatcher(std::string text, std::string pattern);
  * @param pi The prefix table computed by computerPrefixFunction()
  * @return int The number of pattern ocurrences in text
  */
-int kmpMatcher(std::string text, std::string pattern, int pi[]);
+int kmpMatcher(std::string_view text, std::string_view pattern, const int pi[]);
+
+/**
+ * @brief Vectorized matching: a filter on the first and last characters of the pattern, 16 positions at a time (SSE2),
+ * then a full comparison of the positions that pass it. Without SSE2, the same filter a position at a time
+ * @see kmpMatcher
+ * 
+ * @param text The text to be processed
+ * @param pattern The pattern to be found in text
+ * @retval The number of pattern ocurrences in text
+ */
+int simdMatcher(std::string_view text, std::string_view pattern);
 
 /**
  * @brief The Levenshtein Distance algorithm
+ * Bit-parallel (Myers/Hyyro): a column of the matrix is computed with a few word operations for each 64 pattern characters
+ * 
+ * @param text The text to be processed
+ * @param pattern The pattern to be found in text
+ * @return int The number of changes in pattern for matching text
+ */
+int editDistance(std::string_view text, std::string_view pattern);
+
+/**
+ * @brief The Levenshtein Distance algorithm, that gives up once the distance is bigger than maxDiff
+ * 
+ * @param text The text to be processed
+ * @param pattern The pattern to be found in text
+ * @param maxDiff The biggest distance of interest
+ * @return int The number of changes in pattern for matching text, or maxDiff + 1 if it is bigger than maxDiff
+ */
+int editDistance(std::string_view text, std::string_view pattern, int maxDiff);
+
+/**
+ * @brief The smallest Levenshtein Distance between the pattern and any substring of the text (Sellers' problem)
+ * e.g. "carolna" is at distance 1 of "carolina michaelis"
+ * 
+ * @param text The text to be processed
+ * @param pattern The pattern to be found in text
+ * @param maxDiff The biggest distance of interest
+ * @return int The number of changes in pattern for matching some part of text, or maxDiff + 1 if it is bigger than maxDiff
+ */
+int substringEditDistance(std::string_view text, std::string_view pattern, int maxDiff);
+
+/**
+ * @brief The classic dynamic programming Levenshtein Distance, a cell at a time
+ * Kept as reference for the bit-parallel editDistance()
  * 
  * @param text The text to be processed
  * @param pattern The pattern to be found in text
  * @return int The number of changes in pattern for matching text
  */
-int editDistance(std::string text, std::string pattern);
+int editDistanceDP(std::string text, std::string pattern);
+
+/**
+ * @brief A pattern prepared once to be matched against many texts (e.g. the text looked up, against every station)
+ * Keeps the KMP prefix table and the bit-parallel edit distance tables, so matching it allocates no memory
+ * (but for the edit distances of patterns longer than 64 characters)
+ */
+class CompiledPattern {
+private:
+	std::string pattern;
+	std::vector<int> pi;		// the KMP prefix table
+	int numBlocks;				// blocks of 64 characters of the pattern
+	std::vector<uint64_t> Peq;	// the rows of each block where each character occurs
+
+public:
+	explicit CompiledPattern(std::string_view pattern);
+
+	const std::string &getPattern() const;
+	unsigned int length() const;
+
+	/**
+	 * @brief The number of occurrences of the pattern in a text (KMP)
+	 */
+	int count(std::string_view text) const;
+
+	/**
+	 * @brief Tells if the pattern occurs in a text, stopping at the first occurrence
+	 * @see simdMatcher
+	 */
+	bool isFoundIn(std::string_view text) const;
+
+	/**
+	 * @brief The Levenshtein Distance between the pattern and a text, or maxDiff + 1 if it is bigger than maxDiff
+	 * @see editDistance
+	 */
+	int editDistance(std::string_view text, int maxDiff) const;
+
+	/**
+	 * @brief The smallest Levenshtein Distance between the pattern and a substring of a text, or maxDiff + 1 if it is bigger than maxDiff
+	 * @see substringEditDistance
+	 */
+	int substringEditDistance(std::string_view text, int maxDiff) const;
+};
 
 
 std::vector<std::string> tokenize(const std::string &s);
 
+/**
+ * @brief The words of a text, split by spaces, as views of the text, without allocating memory
+ * Unlike tokenize(), the empty words between consecutive spaces are skipped
+ * e.g. for (std::string_view word : Tokens(name)) ...
+ * The text must outlive the iteration
+ */
+class Tokens {
+private:
+	std::string_view text;
+
+public:
+	class iterator {
+	private:
+		std::string_view rest;	// the text after the current word
+		std::string_view word;	// the current word, empty past the last one
+
+		void advance();
+
+	public:
+		explicit iterator(std::string_view rest);
+
+		std::string_view operator*() const { return word; }
+		iterator &operator++() { advance(); return *this; }
+		bool operator!=(const iterator &other) const { return word.data() != other.word.data() || word.length() != other.word.length(); }
+	};
+
+	explicit Tokens(std::string_view text);
+
+	iterator begin() const;
+	iterator end() const;
+};
+
 
 /**
  * @brief A more heavy string matching approaching, where the the text string, stationName, is splitted in tokens, and for each token tries to approximate to the userStationInput
- * Moreover, some unwanted tokens are removed, such determiners. 
+ * Both are folded first, and some unwanted tokens are removed from the station name, such determiners. 
  * @see removeWordsFromDictionary
  * 
  * @param stationName
@@ -71,9 +176,36 @@ std::vector<std::string> tokenize(const std::string &s);
 int tokenizeAndSearch(std::string stationName, std::string userStationInput);
 
 /**
- * @brief An utility function to remove tokens from a give container of strings
+ * @brief An utility function to remove tokens from a give container of strings (every occurrence)
  * The tokens to be removed are specified in stringSearch.cpp#myDictionary
  * 
  * @param tokens The container of tokens to be processed
  */
-void removeWordsFromDictionary(std::vector<std::string> &tokens);
\ No newline at end of file
+void removeWordsFromDictionary(std::vector<std::string> &tokens);
+
+/**
+ * @brief Tells if a word is one of the common words in stringSearch.cpp#myDictionary
+ * 
+ * @param word The word, in lower case
+ * @return true if it is a common word
+ */
+bool isCommonWord(std::string_view word);
+
+/**
+ * @brief Folds the case and the accents of an UTF-8 text, so "Água" and "agua" compare equal
+ * Letters with accents of the Latin-1 Supplement block become their ASCII letter, other non ASCII bytes are kept
+ * 
+ * @param s The text
+ * @return The folded text
+ */
+std::string foldText(const std::string &s);
+
+/**
+ * @brief Normalizes a name for searching: folds the case and the accents, and removes the common words
+ * e.g. "Casa da Música" becomes "casa musica"
+ * 
+ * @param s The name
+ * @return The normalized name, with its words separated by single spaces
+ */
+std::string normalizeName(const std::string &s);
+